@@ -0,0 +1,174 @@
+#!/usr/bin/env bash
+# Checks the code the compilers generate for the hot kernels.
+#
+#   codegenCheck.sh [--compilers "g++ clang++"] [--objdump PATH]
+#                   [--release-flags FLAGS] [--avx2-flags FLAGS]
+#                   [--baseline FILE] [--update]
+#
+# codegenProbes.cpp is compiled with every compiler found at the release
+# flags, once for plain x86-64 and once with the AVX2 kernel flags, then
+# disassembled. ctest passes both from the build (CMAKE_CXX_FLAGS_RELEASE
+# and KERNELS_ISA_Avx2_FLAGS), so they follow CMakeLists.txt; the defaults
+# below are a copy for running the script by hand:
+# - a branchless_* probe with a conditional jump fails the check, the jumps
+#   are printed
+# - the instruction count of every probe is compared with the baseline
+#   (codegenBaseline.txt), growing by more than CODEGEN_TOLERANCE percent
+#   (default 10) fails, shrinking is reported, --update rewrites the
+#   baseline lines of the compilers that ran
+# Compilers that are not installed are skipped, at least one has to run.
+# Counts are kept per compiler family and major version, a new compiler
+# version starts without baseline and only gets the branch check. Only
+# gcc-12 counts are recorded so far, clang runs get the branch check alone
+# until someone with clang installed runs --update.
+
+set -euo pipefail
+
+SOURCE_DIR=$(cd "$(dirname "$0")/.." && pwd)
+PROBES="$SOURCE_DIR/benchmarks/codegenProbes.cpp"
+BASELINE="$SOURCE_DIR/benchmarks/codegenBaseline.txt"
+COMPILERS=${CODEGEN_COMPILERS:-"g++ clang++"}
+OBJDUMP=${OBJDUMP:-objdump}
+TOLERANCE=${CODEGEN_TOLERANCE:-10}
+UPDATE=0
+RELEASE_FLAGS="-std=c++20 -O3 -DNDEBUG"
+ISAS="scalar avx2"
+ISA_FLAGS_scalar=""
+ISA_FLAGS_avx2="-mavx2 -mbmi2 -mlzcnt -mfma"
+
+while [ $# -gt 0 ]; do
+  case "$1" in
+    --compilers) COMPILERS="$2"; shift 2 ;;
+    --objdump) OBJDUMP="$2"; shift 2 ;;
+    --release-flags) RELEASE_FLAGS="$2"; shift 2 ;;
+    --avx2-flags) ISA_FLAGS_avx2="$2"; shift 2 ;;
+    --baseline) BASELINE="$2"; shift 2 ;;
+    --update) UPDATE=1; shift ;;
+    *) echo "unknown option $1" >&2; exit 1 ;;
+  esac
+done
+
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+# the baseline without the comments, empty when there is none yet
+BASELINE_LINES="$WORK_DIR/baseline-lines.txt"
+if [ -f "$BASELINE" ]; then
+  grep -v '^#' "$BASELINE" > "$BASELINE_LINES" || true
+else
+  : > "$BASELINE_LINES"
+fi
+
+# gcc-12, clang-17, the baseline key of a compiler
+compiler_id() {
+  local family=gcc
+  if "$1" --version | grep -qi clang; then
+    family=clang
+  fi
+  echo "$family-$("$1" -dumpversion | cut -d. -f1)"
+}
+
+# "probe instructions conditional_jumps" per line, alignment padding after
+# the last ret is not counted, gcc .cold parts count for their function
+count_instructions() {
+  "$OBJDUMP" -d --no-show-raw-insn "$1" | awk '
+    /^[0-9a-f]+ <.*>:$/ {
+      name = substr($2, 2, length($2) - 3)
+      sub(/\.cold$/, "", name)
+      probe = (name ~ /^(branchless|tracked)_/)
+      next
+    }
+    probe && /^ +[0-9a-f]+:\t/ {
+      split($0, fields, "\t")
+      split(fields[2], words, " ")
+      mnemonic = words[1]
+      if (mnemonic ~ /^(nop|xchg|data16|cs|int3)/) {
+        next
+      }
+      count[name]++
+      if (mnemonic ~ /^j/ && mnemonic != "jmp") {
+        jumps[name]++
+        gsub(/ /, "", fields[1])
+        where[name] = where[name] " " fields[1] mnemonic
+      }
+    }
+    END {
+      for (name in count) {
+        printf "%s %d %d%s\n", name, count[name], jumps[name], where[name]
+      }
+    }' | sort
+}
+
+FAILED=0
+RAN=0
+RESULTS="$WORK_DIR/results.txt"
+: > "$RESULTS"
+
+for compiler in $COMPILERS; do
+  if ! command -v "$compiler" > /dev/null 2>&1; then
+    echo "skipping $compiler, not installed"
+    continue
+  fi
+  RAN=1
+  id=$(compiler_id "$compiler")
+  for isa in $ISAS; do
+    flags_var="ISA_FLAGS_$isa"
+    object="$WORK_DIR/probes-$id-$isa.o"
+    # shellcheck disable=SC2086
+    "$compiler" $RELEASE_FLAGS ${!flags_var} -c "$PROBES" -o "$object"
+    count_instructions "$object" | while read -r probe instructions jumps where; do
+      echo "$id $isa $probe $instructions $jumps $where"
+    done >> "$RESULTS"
+  done
+done
+
+if [ "$RAN" -eq 0 ]; then
+  echo "none of the compilers ($COMPILERS) is installed" >&2
+  exit 1
+fi
+
+printf "%-10s %-7s %-45s %6s %8s  %s\n" compiler isa probe count baseline status
+while read -r id isa probe instructions jumps where; do
+  baseline=$(awk -v id="$id" -v isa="$isa" -v probe="$probe" \
+    '$1 == id && $2 == isa && $3 == probe { print $4 }' "$BASELINE_LINES")
+  status=ok
+  if [[ "$probe" == branchless_* && "$jumps" -gt 0 ]]; then
+    status="FAIL $jumps conditional jumps:$where"
+    FAILED=1
+  elif [ -z "$baseline" ]; then
+    status="new"
+  elif [ "$instructions" -gt $((baseline + baseline * TOLERANCE / 100)) ]; then
+    status="FAIL grew by more than $TOLERANCE%"
+    FAILED=1
+  elif [ "$instructions" -lt "$baseline" ]; then
+    status="shrank, --update to record it"
+  fi
+  printf "%-10s %-7s %-45s %6s %8s  %s\n" "$id" "$isa" "$probe" \
+    "$instructions" "${baseline:--}" "$status"
+done < "$RESULTS"
+
+# probes that are in the baseline for a compiler that ran but were not found
+for id in $(cut -d' ' -f1 "$RESULTS" | sort -u); do
+  while read -r baseId isa probe _; do
+    if [ "$baseId" = "$id" ] &&
+       ! grep -q "^$id $isa $probe " "$RESULTS"; then
+      echo "$id $isa $probe missing from the disassembly"
+      FAILED=1
+    fi
+  done < "$BASELINE_LINES"
+done
+
+if [ "$UPDATE" -eq 1 ]; then
+  ids=$(cut -d' ' -f1 "$RESULTS" | sort -u | paste -sd'|')
+  {
+    echo "# compiler isa probe instructions, written by codegenCheck.sh --update"
+    {
+      grep -Ev "^($ids) " "$BASELINE_LINES" || true
+      cut -d' ' -f1-4 "$RESULTS"
+    } | LC_ALL=C sort
+  } > "$WORK_DIR/baseline.txt"
+  cp "$WORK_DIR/baseline.txt" "$BASELINE"
+  echo "baseline updated: $BASELINE"
+  exit 0
+fi
+
+exit "$FAILED"
@@ -0,0 +1,121 @@
+// Out of line copies of the hot inline kernels for codegenCheck.sh, which
+// compiles this file with every compiler at the release flags (plain x86-64
+// and AVX2) and disassembles it. Probes named branchless_* must not contain
+// a conditional jump, the other ones (tracked_*) are there for their
+// instruction count only, codegenBaseline.txt has the counts per compiler.
+// Not part of any target, the functions are never called.
+
+#include "../floatingPoint/floatingPointSoftware.h"
+
+#if defined(__AVX2__) && defined(__BMI2__)
+#include "../branchless/uv.h"
+#include "../floatingPoint/swFloat8.h"
+#endif
+
+#include <cstdint>
+
+#define CODEGEN_PROBE extern "C" __attribute__((noinline, used))
+
+// soft float building blocks, the comments in floatingPointSoftware.h about
+// cmov and MSVC are about these
+CODEGEN_PROBE uint32_t branchless_findHighestBit(uint32_t v) {
+  return findHighestBit(v);
+}
+
+CODEGEN_PROBE uint32_t branchless_findHighestBitConstExpr(uint32_t v) {
+  return findHighestBitConstExpr(v);
+}
+
+CODEGEN_PROBE uint32_t branchless_normalize32BitMantissaInPlace(uint32_t m) {
+  uint32_t bit = normalize32BitMantissaInPlace(m);
+  return bit + m;
+}
+
+CODEGEN_PROBE uint32_t branchless_roundMantissa(uint32_t m) {
+  return roundMantissa(m);
+}
+
+CODEGEN_PROBE uint32_t branchless_swFloatPackBits(uint32_t sign,
+                                                  uint32_t exponent,
+                                                  uint32_t mantissa) {
+  return swFloatPackBits(sign, exponent, mantissa);
+}
+
+// the branchy versions they are compared with
+CODEGEN_PROBE int tracked_normalize32BitMantissaInPlaceJumps(int m) {
+  int bit = normalize32BitMantissaInPlaceJumps(m);
+  return bit + m;
+}
+
+CODEGEN_PROBE int tracked_roundMantissaOneJump(int m) {
+  return roundMantissaOneJump(m);
+}
+
+CODEGEN_PROBE int tracked_roundMantissaTwoJump(int m) {
+  return roundMantissaTwoJump(m);
+}
+
+// the operations have data dependent loops (shiftExponent, the division)
+CODEGEN_PROBE float tracked_swFloatAddition(float a, float b) {
+  return swFloatAddition(SWFloat(a), SWFloat(b)).original;
+}
+
+CODEGEN_PROBE float tracked_swFloatMultiplication(float a, float b) {
+  return swFloatMultiplication(SWFloat(a), SWFloat(b)).original;
+}
+
+CODEGEN_PROBE float tracked_swFloatDivision(float a, float b) {
+  return swFloatDivision(SWFloat(a), SWFloat(b)).original;
+}
+
+#if defined(__AVX2__) && defined(__BMI2__)
+
+CODEGEN_PROBE void branchless_offsetUVsNoBranch1(const float *uv,
+                                                 float *offsetUV) {
+  offsetUVsNoBranch1(uv, offsetUV);
+}
+
+CODEGEN_PROBE void branchless_offsetUVsNoBranch2(const float *uv,
+                                                 float *offsetUV) {
+  offsetUVsNoBranch2(uv, offsetUV);
+}
+
+CODEGEN_PROBE void branchless_offsetUVsNoBranch3(const float *uv,
+                                                 float *offsetUV) {
+  offsetUVsNoBranch3(uv, offsetUV);
+}
+
+CODEGEN_PROBE void branchless_offsetUVsNoBranchDouble(const double *uv,
+                                                      double *offsetUV,
+                                                      double offset) {
+  offsetUVsNoBranch(uv, offsetUV, UVOffsets<double>(offset));
+}
+
+CODEGEN_PROBE __m256 branchless_compress256(__m256 src, unsigned int mask) {
+  return compress256(src, mask);
+}
+
+CODEGEN_PROBE void tracked_offsetUVs(const float *uv, float *offsetUV) {
+  offsetUVs(uv, offsetUV);
+}
+
+CODEGEN_PROBE __m256i branchless_swFloatAddition8(__m256i a, __m256i b) {
+  return swFloatAddition8(a, b);
+}
+
+CODEGEN_PROBE __m256i branchless_swFloatMultiplication8(__m256i a, __m256i b) {
+  return swFloatMultiplication8(a, b);
+}
+
+// comparisons, select, min and max are blends on the masks
+CODEGEN_PROBE __m256 branchless_swFloat8Clamp(__m256 value, __m256 lo,
+                                              __m256 hi) {
+  return min(max(SWFloat8(value), SWFloat8(lo)), SWFloat8(hi)).floats();
+}
+
+// fixed trip count, the loop jump is the only one
+CODEGEN_PROBE __m256i tracked_swFloatDivision8(__m256i a, __m256i b) {
+  return swFloatDivision8(a, b);
+}
+
+#endif
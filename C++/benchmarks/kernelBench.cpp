@@ -0,0 +1,434 @@
+// Times every kernel variant, branchy and branchless, on the same operands.
+// The operands are either generated or loaded from a directory of recorded
+// distributions (raw little endian arrays), which is what the PGO pipeline
+// trains on, see pgo.sh. Output is one "name,nanoseconds per call" line per
+// kernel so that runs of different builds can be compared.
+//
+// kernelBench [--count N] [--repetitions R] [--operands DIR] [--record DIR]
+
+#include "../branchless/uv.h"
+#include "../branchless/uvBatch.h"
+#include "../branchless/uvMesh.h"
+#include "../dispatch/isaDispatch.h"
+#include "../floatingPoint/exactAccumulator.h"
+#include "../floatingPoint/floatingPointSoftware.h"
+#include "../floatingPoint/softFloatBatch.h"
+#include "../testbuildqt/include/kernelentries.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct Operands {
+  // interleaved (u, v) pairs
+  vector<float> uvs;
+  // 27 bits mantissas with the grs bits, input of the rounding
+  vector<uint32_t> rounding;
+  // mantissas as produced by the soft float adds, input of the normalization
+  vector<uint32_t> normalize;
+  // interleaved (a, b) normal floats
+  vector<float> floats;
+};
+
+static Operands generateOperands(size_t count) {
+  Operands operands;
+  mt19937 rng(1234);
+  uniform_real_distribution<float> unit(0.0f, 1.0f);
+  operands.uvs.resize(2 * count);
+  for (float &value : operands.uvs) {
+    value = unit(rng);
+  }
+  operands.rounding.resize(count);
+  for (uint32_t &value : operands.rounding) {
+    value = rng() & ((1u << 27) - 1);
+  }
+  operands.normalize.resize(count);
+  for (uint32_t &value : operands.normalize) {
+    value = (rng() >> (4 + rng() % 24)) | 16u;
+  }
+  operands.floats.resize(2 * count);
+  for (float &value : operands.floats) {
+    uint32_t bits = (rng() & 0x807FFFFFu) | ((65 + rng() % 125) << 23);
+    memcpy(&value, &bits, sizeof(bits));
+  }
+  return operands;
+}
+
+template <typename T>
+static bool writeArray(const string &path, const vector<T> &data) {
+  FILE *file = fopen(path.c_str(), "wb");
+  if (!file) {
+    return false;
+  }
+  size_t written = fwrite(data.data(), sizeof(T), data.size(), file);
+  fclose(file);
+  return written == data.size();
+}
+
+template <typename T>
+static bool readArray(const string &path, vector<T> &data) {
+  FILE *file = fopen(path.c_str(), "rb");
+  if (!file) {
+    return false;
+  }
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+  data.resize(size / sizeof(T));
+  size_t read = fread(data.data(), sizeof(T), data.size(), file);
+  fclose(file);
+  return read == data.size() && !data.empty();
+}
+
+static bool recordOperands(const string &dir, const Operands &operands) {
+  return writeArray(dir + "/uv.bin", operands.uvs) &&
+         writeArray(dir + "/rounding.bin", operands.rounding) &&
+         writeArray(dir + "/normalize.bin", operands.normalize) &&
+         writeArray(dir + "/floats.bin", operands.floats);
+}
+
+static bool loadOperands(const string &dir, Operands &operands) {
+  return readArray(dir + "/uv.bin", operands.uvs) &&
+         readArray(dir + "/rounding.bin", operands.rounding) &&
+         readArray(dir + "/normalize.bin", operands.normalize) &&
+         readArray(dir + "/floats.bin", operands.floats);
+}
+
+struct Mesh {
+  vector<uint32_t> indices;
+  vector<float> uvs;
+};
+
+// grid with about count vertices, vertices and triangles shuffled, which is
+// the worst case for the gathers of offsetMeshUVs
+static Mesh generateMesh(size_t count) {
+  const uint32_t side = max<uint32_t>(2, uint32_t(sqrt(double(count))));
+  mt19937 rng(4321);
+  vector<uint32_t> vertexOrder(side * side);
+  iota(vertexOrder.begin(), vertexOrder.end(), 0u);
+  shuffle(vertexOrder.begin(), vertexOrder.end(), rng);
+
+  Mesh mesh;
+  mesh.uvs.resize(2 * side * side);
+  for (uint32_t y = 0; y < side; ++y) {
+    for (uint32_t x = 0; x < side; ++x) {
+      uint32_t v = vertexOrder[y * side + x];
+      mesh.uvs[2 * v] = 0.5f * x / side;
+      mesh.uvs[2 * v + 1] = 0.5f * y / side;
+    }
+  }
+  vector<uint32_t> cells((side - 1) * (side - 1));
+  iota(cells.begin(), cells.end(), 0u);
+  shuffle(cells.begin(), cells.end(), rng);
+  for (uint32_t cell : cells) {
+    uint32_t x = cell % (side - 1);
+    uint32_t y = cell / (side - 1);
+    uint32_t a = vertexOrder[y * side + x];
+    uint32_t b = vertexOrder[y * side + x + 1];
+    uint32_t c = vertexOrder[(y + 1) * side + x];
+    uint32_t d = vertexOrder[(y + 1) * side + x + 1];
+    mesh.indices.insert(mesh.indices.end(), {a, b, c, b, d, c});
+  }
+  return mesh;
+}
+
+// keeps the compiler from throwing away the results
+static volatile uint32_t sink;
+
+// best time over the repetitions, in nanoseconds per call
+template <typename F>
+static double timeKernel(F body, size_t calls, int repetitions) {
+  double best = 1e30;
+  for (int r = 0; r < repetitions; ++r) {
+    auto start = chrono::high_resolution_clock::now();
+    sink = body();
+    auto end = chrono::high_resolution_clock::now();
+    double nanos = chrono::duration<double, nano>(end - start).count();
+    best = min(best, nanos / double(calls));
+  }
+  return best;
+}
+
+static void report(const char *name, double nanos) {
+  printf("%s,%.4f\n", name, nanos);
+}
+
+// the single call kernels, inlined in their loops like a real caller would.
+// What they compile to depends on the flags, kernelConsole has the loops
+// built for every instruction set, this times the ones of the machine
+static void reportSingleCalls(kernel_console::KernelFamily family,
+                              const kernel_console::Inputs &inputs,
+                              size_t count, int repetitions) {
+  using namespace kernel_console;
+  const vector<KernelEntry> &entries = dispatch::selectKernel(
+      &singleCallKernelsScalar, &singleCallKernelsAvx2,
+      &singleCallKernelsAvx512)();
+  vector<float> out(2 * count);
+  for (const KernelEntry &entry : entries) {
+    if (entry.info.family == family) {
+      report(entry.info.name,
+             timeKernel([&]() { return entry.function(inputs, out, 0, count); },
+                        count, repetitions));
+    }
+  }
+}
+
+template <typename F>
+static double timeMantissaKernel(const vector<uint32_t> &mantissas, F kernel,
+                                 int repetitions) {
+  return timeKernel(
+      [&]() {
+        uint32_t checksum = 0;
+        for (uint32_t m : mantissas) {
+          checksum += kernel(m);
+        }
+        return checksum;
+      },
+      mantissas.size(), repetitions);
+}
+
+static int usage() {
+  fprintf(stderr, "usage: kernelBench [--count N] [--repetitions R] "
+                  "[--operands DIR] [--record DIR]\n");
+  return 1;
+}
+
+// a positive whole number and nothing after it
+static bool parsePositive(const char *text, unsigned long long &value) {
+  char *end = nullptr;
+  value = strtoull(text, &end, 10);
+  return *text >= '0' && *text <= '9' && *end == '\0' && value > 0;
+}
+
+int main(int argc, char *argv[]) {
+  size_t count = 1 << 20;
+  int repetitions = 5;
+  string operandsDir;
+  string recordDir;
+  for (int i = 1; i < argc; ++i) {
+    const char *option = argv[i];
+    bool numeric = strcmp(option, "--count") == 0 ||
+                   strcmp(option, "--repetitions") == 0;
+    if (!numeric && strcmp(option, "--operands") != 0 &&
+        strcmp(option, "--record") != 0) {
+      fprintf(stderr, "unknown option %s\n", option);
+      return usage();
+    }
+    // all the options take a value
+    if (i + 1 == argc) {
+      fprintf(stderr, "missing value for %s\n", option);
+      return usage();
+    }
+    const char *value = argv[++i];
+    unsigned long long number = 0;
+    if (numeric && (!parsePositive(value, number) || number > INT_MAX)) {
+      fprintf(stderr, "%s wants a positive number, not %s\n", option, value);
+      return usage();
+    }
+    if (strcmp(option, "--count") == 0) {
+      count = size_t(number);
+    } else if (strcmp(option, "--repetitions") == 0) {
+      repetitions = int(number);
+    } else if (strcmp(option, "--operands") == 0) {
+      operandsDir = value;
+    } else {
+      recordDir = value;
+    }
+  }
+
+  Operands operands;
+  if (!operandsDir.empty()) {
+    if (!loadOperands(operandsDir, operands)) {
+      fprintf(stderr, "could not load the operands from %s\n",
+              operandsDir.c_str());
+      return 1;
+    }
+  } else {
+    operands = generateOperands(count);
+  }
+  if (!recordDir.empty()) {
+    if (!recordOperands(recordDir, operands)) {
+      fprintf(stderr, "could not record the operands in %s\n",
+              recordDir.c_str());
+      return 1;
+    }
+  }
+
+  kernel_console::Inputs inputs;
+  inputs.uvs = operands.uvs;
+  inputs.floats = operands.floats;
+
+  const vector<float> &uvs = operands.uvs;
+  const size_t uvCount = uvs.size() / 2;
+  vector<float> uvOut(uvs.size());
+  reportSingleCalls(kernel_console::KernelFamily::UVOffset, inputs, uvCount,
+                    repetitions);
+  report("offsetUVsBatch", timeKernel(
+                               [&]() {
+                                 offsetUVsBatch(uvs.data(), uvOut.data(),
+                                                uvCount);
+                                 uint32_t bits;
+                                 memcpy(&bits, &uvOut[0], sizeof(bits));
+                                 return bits;
+                               },
+                               uvCount, repetitions));
+  // per call offset, should match the line above, and the double path
+  report("offsetUVsBatchOffset", timeKernel(
+                                     [&]() {
+                                       offsetUVsBatch(uvs.data(), uvOut.data(),
+                                                      uvCount, 1.0f / 512.0f);
+                                       uint32_t bits;
+                                       memcpy(&bits, &uvOut[0], sizeof(bits));
+                                       return bits;
+                                     },
+                                     uvCount, repetitions));
+  vector<double> uvsDouble(uvs.begin(), uvs.end());
+  vector<double> uvOutDouble(uvs.size());
+  report("offsetUVsBatchDouble",
+         timeKernel(
+             [&]() {
+               offsetUVsBatch(uvsDouble.data(), uvOutDouble.data(), uvCount,
+                              1.0 / 512.0);
+               return uint32_t(uvOutDouble[0] * 1e6);
+             },
+             uvCount, repetitions));
+
+  // mesh front end, nanoseconds per corner: shuffled as it comes, visited in
+  // morton order, and rewritten once in morton order
+  Mesh mesh = generateMesh(uvCount);
+  const size_t triangles = mesh.indices.size() / 3;
+  vector<float> meshOut(2 * mesh.indices.size());
+  auto timeMesh = [&](const Mesh &m, const uint32_t *order) {
+    return timeKernel(
+        [&]() {
+          offsetMeshUVs(m.indices.data(), triangles, m.uvs.data(),
+                        m.uvs.size() / 2, order, meshOut.data());
+          uint32_t bits;
+          memcpy(&bits, &meshOut[0], sizeof(bits));
+          return bits;
+        },
+        3 * triangles, repetitions);
+  };
+  vector<uint32_t> order(triangles);
+  mortonTriangleOrder(mesh.indices.data(), triangles, mesh.uvs.data(),
+                      order.data());
+  Mesh reordered;
+  reordered.indices.resize(mesh.indices.size());
+  reordered.uvs.resize(mesh.uvs.size());
+  reorderUVMesh(mesh.indices.data(), triangles, mesh.uvs.data(),
+                mesh.uvs.size() / 2, order.data(), reordered.indices.data(),
+                reordered.uvs.data());
+  report("offsetMeshUVsShuffled", timeMesh(mesh, nullptr));
+  report("offsetMeshUVsMorton", timeMesh(mesh, order.data()));
+  report("offsetMeshUVsReordered", timeMesh(reordered, nullptr));
+  // same with the vertex buffer owned by the caller, no allocation per call
+  vector<float> meshScratch(reordered.uvs.size());
+  report("offsetMeshUVsReorderedScratch",
+         timeKernel(
+             [&]() {
+               offsetMeshUVs(reordered.indices.data(), triangles,
+                             reordered.uvs.data(), reordered.uvs.size() / 2,
+                             nullptr, meshOut.data(), UV_OFFSET,
+                             meshScratch.data());
+               uint32_t bits;
+               memcpy(&bits, &meshOut[0], sizeof(bits));
+               return bits;
+             },
+             3 * triangles, repetitions));
+
+  const vector<uint32_t> &rounding = operands.rounding;
+  report("roundMantissa",
+         timeMantissaKernel(
+             rounding, [](uint32_t m) { return roundMantissa(m); },
+             repetitions));
+  report("roundMantissaOneJump",
+         timeMantissaKernel(
+             rounding,
+             [](uint32_t m) { return uint32_t(roundMantissaOneJump(int(m))); },
+             repetitions));
+  report("roundMantissaTwoJump",
+         timeMantissaKernel(
+             rounding,
+             [](uint32_t m) { return uint32_t(roundMantissaTwoJump(int(m))); },
+             repetitions));
+
+  const vector<uint32_t> &normalize = operands.normalize;
+  report("normalize32BitMantissaInPlace",
+         timeMantissaKernel(
+             normalize,
+             [](uint32_t m) { return normalize32BitMantissaInPlace(m) + m; },
+             repetitions));
+  report("normalize32BitMantissaInPlaceJumps",
+         timeMantissaKernel(
+             normalize,
+             [](uint32_t m) {
+               int value = int(m);
+               return uint32_t(normalize32BitMantissaInPlaceJumps(value) +
+                               value);
+             },
+             repetitions));
+
+  const vector<float> &floats = operands.floats;
+  const size_t floatCount = floats.size() / 2;
+  reportSingleCalls(kernel_console::KernelFamily::SoftFloat, inputs,
+                    floatCount, repetitions);
+
+  vector<float> a(floatCount), b(floatCount), out(floatCount);
+  for (size_t i = 0; i < floatCount; ++i) {
+    a[i] = floats[2 * i];
+    b[i] = floats[2 * i + 1];
+  }
+  report("swFloatDivisionBatch", timeKernel(
+                                     [&]() {
+                                       swFloatDivisionBatch(
+                                           a.data(), b.data(), out.data(),
+                                           floatCount);
+                                       uint32_t bits;
+                                       memcpy(&bits, &out[0], sizeof(bits));
+                                       return bits;
+                                     },
+                                     floatCount, repetitions));
+
+  // correctly rounded dot product against the plain float loop and the
+  // double accumulation it replaces, nanoseconds per term
+  report("exactDot", timeKernel(
+                         [&]() {
+                           float dot = exactDot(a.data(), b.data(), floatCount);
+                           uint32_t bits;
+                           memcpy(&bits, &dot, sizeof(bits));
+                           return bits;
+                         },
+                         floatCount, repetitions));
+  report("floatDot", timeKernel(
+                         [&]() {
+                           float dot = 0.0f;
+                           for (size_t i = 0; i < floatCount; ++i) {
+                             dot += a[i] * b[i];
+                           }
+                           uint32_t bits;
+                           memcpy(&bits, &dot, sizeof(bits));
+                           return bits;
+                         },
+                         floatCount, repetitions));
+  report("doubleDot", timeKernel(
+                          [&]() {
+                            double dot = 0.0;
+                            for (size_t i = 0; i < floatCount; ++i) {
+                              dot += double(a[i]) * double(b[i]);
+                            }
+                            return uint32_t(float(dot) != 0.0f);
+                          },
+                          floatCount, repetitions));
+  return 0;
+}
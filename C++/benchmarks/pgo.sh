@@ -0,0 +1,119 @@
+#!/usr/bin/env bash
+# Profile guided optimization of the kernel libraries driven by kernelBench.
+#
+#   pgo.sh [--operands DIR] [--build-dir DIR] [--autofdo]
+#
+# 1. builds the baseline (no profile) and records the operand distribution,
+#    unless one is given with --operands (for example dumped from production)
+# 2. instrumented build (KERNELS_PGO=GENERATE) trained by running kernelBench
+#    on those operands, or with --autofdo a perf sampled baseline run
+# 3. rebuilds with the profile (KERNELS_PGO=USE or AUTOFDO)
+# 4. runs both builds on the same operands and reports the speedup per
+#    function, so branchy and branchless variants are compared each in its
+#    best configuration. Functions the profile made slower are marked and the
+#    script exits with 2 when there is any
+#
+# CXX picks the compiler as usual, with clang the raw profiles are merged with
+# llvm-profdata. AutoFDO needs perf with LBR support and create_gcov (gcc) or
+# llvm-profgen (clang).
+
+set -euo pipefail
+
+SOURCE_DIR=$(cd "$(dirname "$0")/.." && pwd)
+# under build/, which git ignores
+BUILD_DIR="$SOURCE_DIR/build/pgo"
+OPERANDS=""
+AUTOFDO=0
+REPETITIONS=${REPETITIONS:-7}
+
+while [ $# -gt 0 ]; do
+  case "$1" in
+    --operands) OPERANDS=$(cd "$2" && pwd); shift 2 ;;
+    --build-dir) BUILD_DIR="$2"; shift 2 ;;
+    --autofdo) AUTOFDO=1; shift ;;
+    *) echo "unknown option $1" >&2; exit 1 ;;
+  esac
+done
+
+BASELINE_DIR="$BUILD_DIR/baseline"
+# generate and use have to share the build directory, gcc names the profiles
+# after the object files paths
+PROFILED_DIR="$BUILD_DIR/profiled"
+PROFILE_DIR="$BUILD_DIR/profiles"
+mkdir -p "$BUILD_DIR"
+
+build() {
+  local dir=$1
+  shift
+  cmake -S "$SOURCE_DIR" -B "$dir" -DCMAKE_BUILD_TYPE=Release \
+    -DKERNELS_BUILD_TESTS=OFF -DKERNELS_PGO_DIR="$PROFILE_DIR" "$@" > /dev/null
+  cmake --build "$dir" --target kernelBench -j "$(nproc)" > /dev/null
+}
+
+bench() {
+  "$1/kernelBench" --operands "$OPERANDS" --repetitions "$REPETITIONS"
+}
+
+echo "building baseline"
+build "$BASELINE_DIR" -DKERNELS_PGO=OFF -DCMAKE_CXX_FLAGS="-g"
+
+if [ -z "$OPERANDS" ]; then
+  OPERANDS="$BUILD_DIR/operands"
+  mkdir -p "$OPERANDS"
+  "$BASELINE_DIR/kernelBench" --repetitions 1 --record "$OPERANDS" > /dev/null
+fi
+
+if [ "$AUTOFDO" -eq 1 ]; then
+  mkdir -p "$PROFILE_DIR"
+  echo "sampling the baseline with perf"
+  perf record -b -o "$BUILD_DIR/perf.data" -- \
+    "$BASELINE_DIR/kernelBench" --operands "$OPERANDS" --repetitions 3 > /dev/null
+  if command -v create_gcov > /dev/null; then
+    create_gcov --binary="$BASELINE_DIR/kernelBench" \
+      --profile="$BUILD_DIR/perf.data" --gcov="$PROFILE_DIR/kernels.afdo" \
+      -gcov_version=2
+  elif command -v llvm-profgen > /dev/null; then
+    llvm-profgen --binary="$BASELINE_DIR/kernelBench" \
+      --perfdata="$BUILD_DIR/perf.data" --output="$PROFILE_DIR/kernels.afdo"
+  else
+    echo "AutoFDO needs create_gcov or llvm-profgen" >&2
+    exit 1
+  fi
+  echo "building with the sampled profile"
+  build "$PROFILED_DIR" -DKERNELS_PGO=AUTOFDO -DCMAKE_CXX_FLAGS="-g"
+else
+  rm -rf "$PROFILE_DIR"
+  echo "building instrumented"
+  build "$PROFILED_DIR" -DKERNELS_PGO=GENERATE
+  echo "training"
+  "$PROFILED_DIR/kernelBench" --operands "$OPERANDS" --repetitions 1 > /dev/null
+  if ls "$PROFILE_DIR"/*.profraw > /dev/null 2>&1; then
+    llvm-profdata merge -output="$PROFILE_DIR/default.profdata" \
+      "$PROFILE_DIR"/*.profraw
+  fi
+  echo "building with the profile"
+  build "$PROFILED_DIR" -DKERNELS_PGO=USE
+fi
+
+echo "benchmarking"
+bench "$BASELINE_DIR" > "$BUILD_DIR/baseline.csv"
+bench "$PROFILED_DIR" > "$BUILD_DIR/profiled.csv"
+
+# pipefail hands the status of awk through tee
+awk -F, '
+  NR == FNR { baseline[$1] = $2; next }
+  FNR == 1 { printf "%-36s %12s %12s %9s\n", "function", "baseline ns", "pgo ns", "speedup" }
+  {
+    speedup = baseline[$1] / $2
+    slower = speedup < 1.0
+    regressions += slower
+    printf "%-36s %12.3f %12.3f %8.2fx%s\n", $1, baseline[$1], $2, speedup,
+           slower ? "  SLOWER" : ""
+  }
+  END {
+    if (regressions) {
+      printf "%d functions got slower with the profile\n", regressions
+      exit 2
+    }
+  }
+' "$BUILD_DIR/baseline.csv" "$BUILD_DIR/profiled.csv" | tee "$BUILD_DIR/report.txt"
@@ -1,153 +1,17 @@
-//compile with g++ -std-c++11 -mavx2 -mbmi2 -O3 uv.cpp -o uvtest
+//built by the CMakeLists.txt in the C++ folder, target uvtest
 
 
-#include <immintrin.h>
-#include <stdint.h>
+#include "uv.h"
+#include "uvBatch.h"
+#include "../dispatch/isaDispatch.h"
+
 #include <iostream>
 #include <cstdlib>
 #include <chrono>
+#include <vector>
 
 using namespace std;
 
-constexpr float UV_OFFSET = 0.01f;
-constexpr float UV_OFFSET_HALF = UV_OFFSET / 2.0f;
-constexpr float UV_OFFSET_HALF_AVX = -UV_OFFSET / 2.0f;
-const float off_buff[8] = { UV_OFFSET, 
-                   UV_OFFSET_HALF_AVX, 
-                   UV_OFFSET_HALF_AVX,
-                   UV_OFFSET, 
-                   UV_OFFSET_HALF_AVX,
-                   UV_OFFSET_HALF_AVX, 
-                   0.0f,0.0f};
-const float storemask[8] = {0,0,0,0,0,0,1,1};
-
-
-
-void offsetUVs(const float uv[2], float offset_uv[2])
-{
-    float u = uv[0];  
-    float v = uv[1];  
-    float w = 1.0f - u - v;
-    if ( u < v && u <w)
-    {
-        offset_uv[0] = u + UV_OFFSET;
-        offset_uv[1] = v - UV_OFFSET_HALF;
-        return;
-    }
-    if ( v < u && v <w)
-    {
-        offset_uv[0] = u - UV_OFFSET_HALF;
-        offset_uv[1] = v + UV_OFFSET;
-        return;
-    }
-
-    offset_uv[0] = u - UV_OFFSET_HALF;
-    offset_uv[1] = v - UV_OFFSET_HALF;
-
-}
-void offsetUVsNoBranch3(const float uv[2], float offset_uv[2])
-{
-    //ref to make life easier should boil down to no op, compiler
-    //will optimize it away
-    const float& u = uv[0];
-    const float& v = uv[1];
-
-
-    //building the mask
-    float w = 1.0f - (u + v);
-    int isu = (u<v) & (u<w);
-    int isv = (v<u) & (v <w);
-    int isw = !(isu | isv);
-
-    offset_uv[0] = u + (isu * UV_OFFSET) + (isv * UV_OFFSET_HALF_AVX) + (isw * UV_OFFSET_HALF_AVX); 
-    offset_uv[1] = v + (isu * UV_OFFSET_HALF_AVX) + (isv * UV_OFFSET) + (isw * UV_OFFSET_HALF_AVX); 
-}
-
-void offsetUVsNoBranch1(const float uv[2], float offset_uv[2])
-{
-    //ref to make life easier should boil down to no op, compiler
-    //will optimize it away
-    const float& u = uv[0];
-    const float& v = uv[1];
-
-    __m128d uvd =  _mm_loadu_pd(reinterpret_cast<const double*>(uv));
-    __m256d uvreg  = _mm256_broadcastsd_pd(uvd);
-    
-    __m256 offset = _mm256_loadu_ps(off_buff);
-    __m256 to_be_masked =  _mm256_add_ps(_mm256_castpd_ps(uvreg),offset);
-
-    //building the mask
-    float w = 1.0f - (u + v);
-    int isu = (u<v) & (u <w);
-    int isv = (v<u) & (v <w);
-    int isw = !(isu | isv);
-    
-    uint32_t shufmask[8];
-    shufmask[0] =  3*isv + 5*isw;
-    shufmask[1] = shufmask[0]+1;
-    __m256i shufmaskreg = _mm256_load_si256(reinterpret_cast<const __m256i*>(shufmask));
-    __m256 res = _mm256_permutevar8x32_ps(to_be_masked, shufmaskreg);
-
-    
-    __m256i storemaskreg =  _mm256_loadu_si256(reinterpret_cast<const __m256i*>(storemask));
-    _mm256_maskstore_ps(offset_uv,storemaskreg,res);
-}
-
-
-inline __m256 compress256(__m256 src, unsigned int mask /* from movmskps */)
-{
-    //mask is a interger on which each bit, represent wheter or not we should keep the result.
-    //in my case I have a float[8], where 
-    uint64_t expanded_mask = _pdep_u64(mask, 0x0101010101010101);  // unpack each bit to a byte
-    expanded_mask *= 0xFF;    // mask |= mask<<1 | mask<<2 | ... | mask<<7;
-    // ABC... -> AAAAAAAABBBBBBBBCCCCCCCC...: replicate each bit to fill its byte
-    //
-    // the identity shuffle for vpermps, packed to one index per byte
-    const uint64_t identity_indices = 0x0706050403020100;    
-    //extract on lower end the wanted bytes, basically removes and compact remaining
-    //based on the mask, so the result should be the indices we need compacted
-    //on the lower side, which will we use later to get the values we need
-    uint64_t wanted_indices = _pext_u64(identity_indices, expanded_mask);
-    
-    //convertes 64 bits to a 128 register, zeroing out upper 64 register
-    __m128i bytevec = _mm_cvtsi64_si128(wanted_indices);
-    //expands a each byte to a 32 bit
-    __m256i shufmask = _mm256_cvtepu8_epi32(bytevec);
-
-    // 8-32 bit 
-    return _mm256_permutevar8x32_ps(src, shufmask);
-}
-
-//https://godbolt.org/g/FYgupd
-//https://godbolt.org/g/9I0H24
-//http://stackoverflow.com/questions/36932240/avx2-what-is-the-most-efficient-way-to-pack-left-based-on-a-mask
-
-void offsetUVsNoBranch2(const float uv[2], float offset_uv[2])
-{
-    //ref to make life easier should boil down to no op, compiler
-    //will optimize it away
-    const float& u = uv[0];
-    const float& v = uv[1];
-
-    __m128d uvd =  _mm_loadu_pd(reinterpret_cast<const double*>(uv));
-    __m256d uvreg  = _mm256_broadcastsd_pd(uvd);
-    
-    __m256 offset = _mm256_loadu_ps(off_buff);
-    __m256 to_be_masked =  _mm256_add_ps(_mm256_castpd_ps(uvreg),offset);
-
-    //building the mask
-    float w = 1.0f - (u + v);
-    int isu = (u<v) & (u<w);
-    int isv = (v<u) & (v <w);
-    int isw = !(isu | isv);
-    
-    //extending bool and orring rather then mult and add?
-    uint32_t m =3*isu + 12*isv + 48*isw;
-    __m256 res = compress256(to_be_masked, m);
-    
-    __m256i storemaskreg =  _mm256_loadu_si256(reinterpret_cast<const __m256i*>(storemask));
-    _mm256_maskstore_ps(offset_uv,storemaskreg,res);
-}
 int main()
 {
     float uv[2];
@@ -201,5 +65,29 @@ int main()
     nbrt = chrono::duration_cast<chrono::microseconds>(nbr2 - nbr1).count();
     std::cout << "branchlessNoAVX:  "<<nbrt<<" micro"<<std::endl;
     std::cout << "difference: " <<(int) ((1.0f - float(nbrt)/float(brt))*100.0f)<<"%"<<std::endl;
+
+    //batched kernels, the inputs are generated up front so we only time the
+    //kernel itself, every instruction set the cpu supports is timed
+    std::vector<float> uvs(2*ITERATIONS);
+    std::vector<float> uvsOff(2*ITERATIONS);
+    for (uint32_t i=0; i< ITERATIONS; ++i)
+    {
+        uvs[2*i] = static_cast <float> (rand()) / static_cast <float> (RAND_MAX);
+        uvs[2*i+1] = static_cast <float> (rand()) / static_cast <float> (RAND_MAX);
+    }
+    const dispatch::Isa isas[3] = {dispatch::Isa::Scalar, dispatch::Isa::Avx2, dispatch::Isa::Avx512};
+    void (*batches[3])(const float*, float*, size_t) = {offsetUVsBatchScalar, offsetUVsBatchAvx2, offsetUVsBatchAvx512};
+    for (int i=0; i<3; ++i)
+    {
+        if (!dispatch::isaSupported(isas[i]))
+        {
+            continue;
+        }
+        nbr1 = chrono::high_resolution_clock::now();
+        batches[i](uvs.data(), uvsOff.data(), ITERATIONS);
+        nbr2 = chrono::high_resolution_clock::now();
+        nbrt = chrono::duration_cast<chrono::microseconds>(nbr2 - nbr1).count();
+        std::cout << "batch " << dispatch::isaName(isas[i]) << ":  "<<nbrt<<" micro"<<std::endl;
+    }
     return 0;
 }
@@ -0,0 +1,223 @@
+#pragma once
+
+#include <immintrin.h>
+#include <stdint.h>
+
+#include "../dispatch/isaDispatch.h"
+#include "../instrumentation/instrumentation.h"
+
+//the kernels below are compiled once per instruction set, see isaDispatch.h
+KERNEL_ISA_NAMESPACE_BEGIN
+
+constexpr float UV_OFFSET = 0.01f;
+constexpr float UV_OFFSET_HALF = UV_OFFSET / 2.0f;
+constexpr float UV_OFFSET_HALF_AVX = -UV_OFFSET / 2.0f;
+const float off_buff[8] = { UV_OFFSET, 
+                   UV_OFFSET_HALF_AVX, 
+                   UV_OFFSET_HALF_AVX,
+                   UV_OFFSET, 
+                   UV_OFFSET_HALF_AVX,
+                   UV_OFFSET_HALF_AVX, 
+                   0.0f,0.0f};
+//maskstore only looks at the sign bit of each lane, we store the first two
+//lanes, which is where both kernels leave the result
+const int32_t storemask[8] = {-1,-1,0,0,0,0,0,0};
+
+//per call (or per mesh, texel size dependent) offsets, the smallest
+//coordinate gets offset, the other ones move back by half of it. The default
+//is the compile time UV_OFFSET, kernels taking it get constant folded to the
+//same code as the hard coded ones when it is a constant
+template <typename T>
+struct UVOffsets
+{
+    constexpr explicit UVOffsets(T offset = T(UV_OFFSET))
+        : offset(offset), half(-offset / T(2))
+    {
+    }
+
+    T offset;
+    T half;
+};
+
+
+
+inline void offsetUVs(const float uv[2], float offset_uv[2])
+{
+    KERNELS_COUNT(UVOffsetPairs);
+    float u = uv[0];  
+    float v = uv[1];  
+    float w = 1.0f - u - v;
+    if ( u < v && u <w)
+    {
+        offset_uv[0] = u + UV_OFFSET;
+        offset_uv[1] = v - UV_OFFSET_HALF;
+        return;
+    }
+    if ( v < u && v <w)
+    {
+        offset_uv[0] = u - UV_OFFSET_HALF;
+        offset_uv[1] = v + UV_OFFSET;
+        return;
+    }
+
+    offset_uv[0] = u - UV_OFFSET_HALF;
+    offset_uv[1] = v - UV_OFFSET_HALF;
+
+}
+inline void offsetUVsNoBranch3(const float uv[2], float offset_uv[2])
+{
+    KERNELS_COUNT(UVOffsetPairs);
+    //ref to make life easier should boil down to no op, compiler
+    //will optimize it away
+    const float& u = uv[0];
+    const float& v = uv[1];
+
+
+    //building the mask
+    float w = 1.0f - (u + v);
+    int isu = (u<v) & (u<w);
+    int isv = (v<u) & (v <w);
+    int isw = !(isu | isv);
+
+    offset_uv[0] = u + (isu * UV_OFFSET) + (isv * UV_OFFSET_HALF_AVX) + (isw * UV_OFFSET_HALF_AVX); 
+    offset_uv[1] = v + (isu * UV_OFFSET_HALF_AVX) + (isv * UV_OFFSET) + (isw * UV_OFFSET_HALF_AVX); 
+}
+
+//generic version of offsetUVsNoBranch3, float or double, bit identical to it
+//for float with the default offsets. It is the building block of the batch
+//tails, not counted, the callers count the pairs
+template <typename T>
+inline void offsetUVsNoBranch(const T uv[2], T offset_uv[2], const UVOffsets<T>& offsets)
+{
+    const T& u = uv[0];
+    const T& v = uv[1];
+
+    T w = T(1) - (u + v);
+    int isu = (u<v) & (u<w);
+    int isv = (v<u) & (v <w);
+    int isw = !(isu | isv);
+
+    offset_uv[0] = u + (isu * offsets.offset) + (isv * offsets.half) + (isw * offsets.half);
+    offset_uv[1] = v + (isu * offsets.half) + (isv * offsets.offset) + (isw * offsets.half);
+}
+
+//the following kernels need AVX2 and BMI2, when building for a plain x86-64
+//target only the scalar ones above are available
+#if defined(__AVX2__) && defined(__BMI2__)
+//same layout as off_buff, built from per call offsets, a single constant
+//load when the offsets are known at compile time
+inline __m256 offsetLanes(const UVOffsets<float>& offsets)
+{
+    return _mm256_setr_ps(offsets.offset, offsets.half, offsets.half,
+                          offsets.offset, offsets.half, offsets.half, 0.0f, 0.0f);
+}
+
+inline void offsetUVsNoBranch1(const float uv[2], float offset_uv[2],
+                               const UVOffsets<float>& offsets)
+{
+    KERNELS_COUNT(UVOffsetPairs);
+    //ref to make life easier should boil down to no op, compiler
+    //will optimize it away
+    const float& u = uv[0];
+    const float& v = uv[1];
+
+    //only 64 bits are loaded, the uv pair, the broadcast uses the lower lane
+    __m128d uvd = _mm_castsi128_pd(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(uv)));
+    __m256d uvreg  = _mm256_broadcastsd_pd(uvd);
+    
+    __m256 offset = offsetLanes(offsets);
+    __m256 to_be_masked =  _mm256_add_ps(_mm256_castpd_ps(uvreg),offset);
+
+    //building the mask
+    float w = 1.0f - (u + v);
+    int isu = (u<v) & (u <w);
+    int isv = (v<u) & (v <w);
+    int isw = !(isu | isv);
+    
+    //the offsetted u is in lane 0, 2 or 4 based on which coordinate is the
+    //smallest, v is right after it
+    alignas(32) uint32_t shufmask[8] = {};
+    shufmask[0] =  2*isv + 4*isw;
+    shufmask[1] = shufmask[0]+1;
+    __m256i shufmaskreg = _mm256_load_si256(reinterpret_cast<const __m256i*>(shufmask));
+    __m256 res = _mm256_permutevar8x32_ps(to_be_masked, shufmaskreg);
+
+    
+    __m256i storemaskreg =  _mm256_loadu_si256(reinterpret_cast<const __m256i*>(storemask));
+    _mm256_maskstore_ps(offset_uv,storemaskreg,res);
+}
+
+inline void offsetUVsNoBranch1(const float uv[2], float offset_uv[2])
+{
+    offsetUVsNoBranch1(uv, offset_uv, UVOffsets<float>());
+}
+
+
+inline __m256 compress256(__m256 src, unsigned int mask /* from movmskps */)
+{
+    KERNELS_COUNT(Compress256Calls);
+    //mask is a interger on which each bit, represent wheter or not we should keep the result.
+    //in my case I have a float[8], where 
+    uint64_t expanded_mask = _pdep_u64(mask, 0x0101010101010101);  // unpack each bit to a byte
+    expanded_mask *= 0xFF;    // mask |= mask<<1 | mask<<2 | ... | mask<<7;
+    // ABC... -> AAAAAAAABBBBBBBBCCCCCCCC...: replicate each bit to fill its byte
+    //
+    // the identity shuffle for vpermps, packed to one index per byte
+    const uint64_t identity_indices = 0x0706050403020100;    
+    //extract on lower end the wanted bytes, basically removes and compact remaining
+    //based on the mask, so the result should be the indices we need compacted
+    //on the lower side, which will we use later to get the values we need
+    uint64_t wanted_indices = _pext_u64(identity_indices, expanded_mask);
+    
+    //convertes 64 bits to a 128 register, zeroing out upper 64 register
+    __m128i bytevec = _mm_cvtsi64_si128(wanted_indices);
+    //expands a each byte to a 32 bit
+    __m256i shufmask = _mm256_cvtepu8_epi32(bytevec);
+
+    // 8-32 bit 
+    return _mm256_permutevar8x32_ps(src, shufmask);
+}
+
+//https://godbolt.org/g/FYgupd
+//https://godbolt.org/g/9I0H24
+//http://stackoverflow.com/questions/36932240/avx2-what-is-the-most-efficient-way-to-pack-left-based-on-a-mask
+
+inline void offsetUVsNoBranch2(const float uv[2], float offset_uv[2],
+                               const UVOffsets<float>& offsets)
+{
+    KERNELS_COUNT(UVOffsetPairs);
+    //ref to make life easier should boil down to no op, compiler
+    //will optimize it away
+    const float& u = uv[0];
+    const float& v = uv[1];
+
+    //only 64 bits are loaded, the uv pair, the broadcast uses the lower lane
+    __m128d uvd = _mm_castsi128_pd(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(uv)));
+    __m256d uvreg  = _mm256_broadcastsd_pd(uvd);
+    
+    __m256 offset = offsetLanes(offsets);
+    __m256 to_be_masked =  _mm256_add_ps(_mm256_castpd_ps(uvreg),offset);
+
+    //building the mask
+    float w = 1.0f - (u + v);
+    int isu = (u<v) & (u<w);
+    int isv = (v<u) & (v <w);
+    int isw = !(isu | isv);
+    
+    //extending bool and orring rather then mult and add?
+    uint32_t m =3*isu + 12*isv + 48*isw;
+    __m256 res = compress256(to_be_masked, m);
+    
+    __m256i storemaskreg =  _mm256_loadu_si256(reinterpret_cast<const __m256i*>(storemask));
+    _mm256_maskstore_ps(offset_uv,storemaskreg,res);
+}
+
+inline void offsetUVsNoBranch2(const float uv[2], float offset_uv[2])
+{
+    offsetUVsNoBranch2(uv, offset_uv, UVOffsets<float>());
+}
+#endif
+
+KERNEL_ISA_NAMESPACE_END
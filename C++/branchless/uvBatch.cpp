@@ -0,0 +1,141 @@
+//compiled once per instruction set, see isaDispatch.h
+
+#include "uvBatch.h"
+#include "uv.h"
+#include "../dispatch/isaDispatch.h"
+
+//Working on whole registers of interleaved pairs we don't need to shuffle the
+//offsets around like offsetUVsNoBranch1 does, every lane looks at its own
+//coordinate ("self") and the other one of the pair, swapped in with an in
+//lane permute:
+//  self is the smallest -> self + offset
+//  anything else        -> self - offset / 2
+//which is exactly what the branchy version does for both u and v. The lanes
+//structs below are the only part that depends on the scalar type and the
+//instruction set
+namespace
+{
+
+#if defined(__AVX512F__)
+struct FloatLanes
+{
+    typedef __m512 Reg;
+    static const size_t PAIRS = 8;
+    static Reg set1(float x) { return _mm512_set1_ps(x); }
+    static Reg load(const float* p) { return _mm512_loadu_ps(p); }
+    static void store(float* p, Reg x) { _mm512_storeu_ps(p, x); }
+    //the shuffle is the same vpermilps, _mm512_permute_ps trips a gcc 12
+    //-Wmaybe-uninitialized false positive in its header
+    static Reg swapPairs(Reg x) { return _mm512_shuffle_ps(x, x, 0xB1); }
+    static Reg add(Reg a, Reg b) { return _mm512_add_ps(a, b); }
+    static Reg sub(Reg a, Reg b) { return _mm512_sub_ps(a, b); }
+    static Reg pick(Reg self, Reg other, Reg w, Reg offset, Reg half)
+    {
+        __mmask16 isSelf = _mm512_cmp_ps_mask(self, other, _CMP_LT_OQ) &
+                           _mm512_cmp_ps_mask(self, w, _CMP_LT_OQ);
+        return _mm512_mask_blend_ps(isSelf, half, offset);
+    }
+};
+
+struct DoubleLanes
+{
+    typedef __m512d Reg;
+    static const size_t PAIRS = 4;
+    static Reg set1(double x) { return _mm512_set1_pd(x); }
+    static Reg load(const double* p) { return _mm512_loadu_pd(p); }
+    static void store(double* p, Reg x) { _mm512_storeu_pd(p, x); }
+    static Reg swapPairs(Reg x) { return _mm512_shuffle_pd(x, x, 0x55); }
+    static Reg add(Reg a, Reg b) { return _mm512_add_pd(a, b); }
+    static Reg sub(Reg a, Reg b) { return _mm512_sub_pd(a, b); }
+    static Reg pick(Reg self, Reg other, Reg w, Reg offset, Reg half)
+    {
+        __mmask8 isSelf = _mm512_cmp_pd_mask(self, other, _CMP_LT_OQ) &
+                          _mm512_cmp_pd_mask(self, w, _CMP_LT_OQ);
+        return _mm512_mask_blend_pd(isSelf, half, offset);
+    }
+};
+#elif defined(__AVX2__)
+struct FloatLanes
+{
+    typedef __m256 Reg;
+    static const size_t PAIRS = 4;
+    static Reg set1(float x) { return _mm256_set1_ps(x); }
+    static Reg load(const float* p) { return _mm256_loadu_ps(p); }
+    static void store(float* p, Reg x) { _mm256_storeu_ps(p, x); }
+    static Reg swapPairs(Reg x) { return _mm256_permute_ps(x, 0xB1); }
+    static Reg add(Reg a, Reg b) { return _mm256_add_ps(a, b); }
+    static Reg sub(Reg a, Reg b) { return _mm256_sub_ps(a, b); }
+    static Reg pick(Reg self, Reg other, Reg w, Reg offset, Reg half)
+    {
+        Reg isSelf = _mm256_and_ps(_mm256_cmp_ps(self, other, _CMP_LT_OQ),
+                                   _mm256_cmp_ps(self, w, _CMP_LT_OQ));
+        return _mm256_blendv_ps(half, offset, isSelf);
+    }
+};
+
+struct DoubleLanes
+{
+    typedef __m256d Reg;
+    static const size_t PAIRS = 2;
+    static Reg set1(double x) { return _mm256_set1_pd(x); }
+    static Reg load(const double* p) { return _mm256_loadu_pd(p); }
+    static void store(double* p, Reg x) { _mm256_storeu_pd(p, x); }
+    static Reg swapPairs(Reg x) { return _mm256_permute_pd(x, 0x5); }
+    static Reg add(Reg a, Reg b) { return _mm256_add_pd(a, b); }
+    static Reg sub(Reg a, Reg b) { return _mm256_sub_pd(a, b); }
+    static Reg pick(Reg self, Reg other, Reg w, Reg offset, Reg half)
+    {
+        Reg isSelf = _mm256_and_pd(_mm256_cmp_pd(self, other, _CMP_LT_OQ),
+                                   _mm256_cmp_pd(self, w, _CMP_LT_OQ));
+        return _mm256_blendv_pd(half, offset, isSelf);
+    }
+};
+#endif
+
+#if defined(__AVX2__)
+template <typename T> struct LanesOf;
+template <> struct LanesOf<float> { typedef FloatLanes Type; };
+template <> struct LanesOf<double> { typedef DoubleLanes Type; };
+#endif
+
+template <typename T>
+void offsetUVsBatchImpl(const T* uv, T* offset_uv, size_t count, const UVOffsets<T>& offsets)
+{
+    size_t i = 0;
+#if defined(__AVX2__)
+    typedef typename LanesOf<T>::Type Lanes;
+    typedef typename Lanes::Reg Reg;
+    const Reg one = Lanes::set1(T(1));
+    const Reg offset = Lanes::set1(offsets.offset);
+    const Reg half = Lanes::set1(offsets.half);
+    for (; i + Lanes::PAIRS <= count; i += Lanes::PAIRS)
+    {
+        Reg self = Lanes::load(uv + 2*i);
+        Reg other = Lanes::swapPairs(self);
+        Reg w = Lanes::sub(one, Lanes::add(self, other));
+        Reg toAdd = Lanes::pick(self, other, w, offset, half);
+        Lanes::store(offset_uv + 2*i, Lanes::add(self, toAdd));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        offsetUVsNoBranch(uv + 2*i, offset_uv + 2*i, offsets);
+    }
+}
+
+}
+
+void KERNEL_ISA_NAME(offsetUVsBatch)(const float* uv, float* offset_uv, size_t count)
+{
+    offsetUVsBatchImpl(uv, offset_uv, count, UVOffsets<float>());
+}
+
+void KERNEL_ISA_NAME(offsetUVsBatch)(const float* uv, float* offset_uv, size_t count, float offset)
+{
+    offsetUVsBatchImpl(uv, offset_uv, count, UVOffsets<float>(offset));
+}
+
+void KERNEL_ISA_NAME(offsetUVsBatch)(const double* uv, double* offset_uv, size_t count, double offset)
+{
+    offsetUVsBatchImpl(uv, offset_uv, count, UVOffsets<double>(offset));
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stddef.h>
+
+//batched version of the uv offset, uv and offset_uv hold count interleaved
+//(u, v) pairs, results are the same as calling offsetUVsNoBranch3 on every
+//pair, the implementation is picked at runtime based on the cpu
+void offsetUVsBatch(const float* uv, float* offset_uv, size_t count);
+
+//per call offset and double precision, same as offsetUVsNoBranch with
+//UVOffsets(offset) on every pair. The offsets are broadcast once per call,
+//the loop is the same as the one of the hard coded version
+void offsetUVsBatch(const float* uv, float* offset_uv, size_t count, float offset);
+void offsetUVsBatch(const double* uv, double* offset_uv, size_t count, double offset);
+
+//single instruction set versions, the avx ones can only be called if the cpu
+//supports them, see dispatch::isaSupported
+#define UV_BATCH_DECLARE(SUFFIX)                                                   \
+    void offsetUVsBatch##SUFFIX(const float* uv, float* offset_uv, size_t count); \
+    void offsetUVsBatch##SUFFIX(const float* uv, float* offset_uv, size_t count,  \
+                                float offset);                                    \
+    void offsetUVsBatch##SUFFIX(const double* uv, double* offset_uv, size_t count,\
+                                double offset);
+
+UV_BATCH_DECLARE(Scalar)
+UV_BATCH_DECLARE(Avx2)
+UV_BATCH_DECLARE(Avx512)
@@ -0,0 +1,33 @@
+#include "uvBatch.h"
+#include "../dispatch/isaDispatch.h"
+#include "../instrumentation/instrumentation.h"
+
+void offsetUVsBatch(const float* uv, float* offset_uv, size_t count)
+{
+    typedef void (*Kernel)(const float*, float*, size_t);
+    static const Kernel kernel = dispatch::selectKernel<Kernel>(
+        offsetUVsBatchScalar, offsetUVsBatchAvx2, offsetUVsBatchAvx512);
+    KERNELS_TRACE_SCOPE("offsetUVsBatch");
+    KERNELS_COUNT_N(UVOffsetPairs, count);
+    kernel(uv, offset_uv, count);
+}
+
+void offsetUVsBatch(const float* uv, float* offset_uv, size_t count, float offset)
+{
+    typedef void (*Kernel)(const float*, float*, size_t, float);
+    static const Kernel kernel = dispatch::selectKernel<Kernel>(
+        offsetUVsBatchScalar, offsetUVsBatchAvx2, offsetUVsBatchAvx512);
+    KERNELS_TRACE_SCOPE("offsetUVsBatch");
+    KERNELS_COUNT_N(UVOffsetPairs, count);
+    kernel(uv, offset_uv, count, offset);
+}
+
+void offsetUVsBatch(const double* uv, double* offset_uv, size_t count, double offset)
+{
+    typedef void (*Kernel)(const double*, double*, size_t, double);
+    static const Kernel kernel = dispatch::selectKernel<Kernel>(
+        offsetUVsBatchScalar, offsetUVsBatchAvx2, offsetUVsBatchAvx512);
+    KERNELS_TRACE_SCOPE("offsetUVsBatch");
+    KERNELS_COUNT_N(UVOffsetPairs, count);
+    kernel(uv, offset_uv, count, offset);
+}
@@ -0,0 +1,195 @@
+#include "uvMesh.h"
+#include "uvBatch.h"
+#include "../instrumentation/instrumentation.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace
+{
+
+//spreads the lower 16 bits so that there is a zero between each of them
+uint32_t spreadBits(uint32_t x)
+{
+    x &= 0xFFFF;
+    x = (x | (x << 8)) & 0x00FF00FF;
+    x = (x | (x << 4)) & 0x0F0F0F0F;
+    x = (x | (x << 2)) & 0x33333333;
+    x = (x | (x << 1)) & 0x55555555;
+    return x;
+}
+
+//uninitialized uv pairs, the batch kernel writes all of them. Faulting a big
+//buffer in 4KB pages cost more than the kernel itself on a 16M vertex grid,
+//from 2MB on it gets huge pages
+template <typename T>
+struct VertexBuffer
+{
+    T* data;
+
+    explicit VertexBuffer(size_t pairs)
+    {
+        const size_t hugePage = size_t(2) << 20;
+        const size_t bytes = 2*pairs*sizeof(T);
+        const size_t alignment = bytes >= hugePage ? hugePage : 64;
+        //aligned_alloc wants a whole number of alignments
+        const size_t size = (bytes + alignment - 1) / alignment * alignment;
+        data = static_cast<T*>(std::aligned_alloc(alignment, size));
+        if (!data && size)
+        {
+            throw std::bad_alloc();
+        }
+#if defined(__linux__)
+        if (alignment == hugePage)
+        {
+            //only a hint, without transparent huge pages it does nothing
+            madvise(data, size, MADV_HUGEPAGE);
+        }
+#endif
+    }
+    ~VertexBuffer() { std::free(data); }
+    VertexBuffer(const VertexBuffer&) = delete;
+    VertexBuffer& operator=(const VertexBuffer&) = delete;
+};
+
+//offset is empty for the hard coded offset, or the per call one, they go
+//straight to the matching offsetUVsBatch. The offset vertices go in scratch
+template <typename T, typename... Offset>
+void offsetMesh(const uint32_t* indices, size_t triangleCount, const T* uvs,
+                size_t vertexCount, const uint32_t* order, T* offset_uv, T* scratch,
+                Offset... offset)
+{
+    KERNELS_TRACE_SCOPE("offsetMeshUVs");
+    offsetUVsBatch(uvs, scratch, vertexCount, offset...);
+    const T* offsetPairs = scratch;
+
+    for (size_t k = 0; k < triangleCount; ++k)
+    {
+        const size_t t = order ? order[k] : k;
+        const uint32_t* corners = indices + 3*t;
+        std::memcpy(offset_uv + 6*k, offsetPairs + 2*size_t(corners[0]), 2*sizeof(T));
+        std::memcpy(offset_uv + 6*k + 2, offsetPairs + 2*size_t(corners[1]), 2*sizeof(T));
+        std::memcpy(offset_uv + 6*k + 4, offsetPairs + 2*size_t(corners[2]), 2*sizeof(T));
+    }
+}
+
+}
+
+void offsetMeshUVs(const uint32_t* indices, size_t triangleCount, const float* uvs,
+                   size_t vertexCount, const uint32_t* order, float* offset_uv)
+{
+    VertexBuffer<float> scratch(vertexCount);
+    offsetMesh(indices, triangleCount, uvs, vertexCount, order, offset_uv, scratch.data);
+}
+
+void offsetMeshUVs(const uint32_t* indices, size_t triangleCount, const float* uvs,
+                   size_t vertexCount, const uint32_t* order, float* offset_uv,
+                   float offset)
+{
+    VertexBuffer<float> scratch(vertexCount);
+    offsetMesh(indices, triangleCount, uvs, vertexCount, order, offset_uv, scratch.data,
+               offset);
+}
+
+void offsetMeshUVs(const uint32_t* indices, size_t triangleCount, const double* uvs,
+                   size_t vertexCount, const uint32_t* order, double* offset_uv,
+                   double offset)
+{
+    VertexBuffer<double> scratch(vertexCount);
+    offsetMesh(indices, triangleCount, uvs, vertexCount, order, offset_uv, scratch.data,
+               offset);
+}
+
+void offsetMeshUVs(const uint32_t* indices, size_t triangleCount, const float* uvs,
+                   size_t vertexCount, const uint32_t* order, float* offset_uv,
+                   float offset, float* scratch)
+{
+    offsetMesh(indices, triangleCount, uvs, vertexCount, order, offset_uv, scratch, offset);
+}
+
+void offsetMeshUVs(const uint32_t* indices, size_t triangleCount, const double* uvs,
+                   size_t vertexCount, const uint32_t* order, double* offset_uv,
+                   double offset, double* scratch)
+{
+    offsetMesh(indices, triangleCount, uvs, vertexCount, order, offset_uv, scratch, offset);
+}
+
+void mortonTriangleOrder(const uint32_t* indices, size_t triangleCount, const float* uvs,
+                         uint32_t* order)
+{
+    //centroids scaled to the bounding box so udim meshes use the whole grid
+    std::vector<float> centroids(2*triangleCount);
+    float lo[2] = {0.0f, 0.0f};
+    float hi[2] = {0.0f, 0.0f};
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        for (int axis = 0; axis < 2; ++axis)
+        {
+            float c = (uvs[2*indices[3*t]   + axis] +
+                       uvs[2*indices[3*t+1] + axis] +
+                       uvs[2*indices[3*t+2] + axis]) * (1.0f / 3.0f);
+            centroids[2*t + axis] = c;
+            lo[axis] = t == 0 ? c : std::min(lo[axis], c);
+            hi[axis] = t == 0 ? c : std::max(hi[axis], c);
+        }
+    }
+
+    //code in the upper half, triangle in the lower one, sorting the keys
+    //gives a deterministic order
+    std::vector<uint64_t> keys(triangleCount);
+    for (size_t t = 0; t < triangleCount; ++t)
+    {
+        uint32_t cell[2];
+        for (int axis = 0; axis < 2; ++axis)
+        {
+            float extent = hi[axis] - lo[axis];
+            float unit = extent > 0.0f ? (centroids[2*t + axis] - lo[axis]) / extent : 0.0f;
+            cell[axis] = uint32_t(std::min(unit, 1.0f) * 65535.0f);
+        }
+        uint64_t code = spreadBits(cell[0]) | (spreadBits(cell[1]) << 1);
+        keys[t] = (code << 32) | t;
+    }
+    std::sort(keys.begin(), keys.end());
+    for (size_t k = 0; k < triangleCount; ++k)
+    {
+        order[k] = uint32_t(keys[k]);
+    }
+}
+
+void reorderUVMesh(const uint32_t* indices, size_t triangleCount, const float* uvs,
+                   size_t vertexCount, const uint32_t* order,
+                   uint32_t* newIndices, float* newUVs)
+{
+    const uint32_t unused = 0xFFFFFFFF;
+    std::vector<uint32_t> remap(vertexCount, unused);
+    uint32_t next = 0;
+    for (size_t k = 0; k < triangleCount; ++k)
+    {
+        const uint32_t* corners = indices + 3*size_t(order[k]);
+        for (int c = 0; c < 3; ++c)
+        {
+            uint32_t& vertex = remap[corners[c]];
+            if (vertex == unused)
+            {
+                vertex = next++;
+            }
+            newIndices[3*k + c] = vertex;
+        }
+    }
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        uint32_t& vertex = remap[v];
+        if (vertex == unused)
+        {
+            vertex = next++;
+        }
+        std::memcpy(newUVs + 2*size_t(vertex), uvs + 2*v, 2*sizeof(float));
+    }
+}
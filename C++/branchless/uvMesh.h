@@ -0,0 +1,60 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+//indexed mesh front end of the uv offset. indices holds 3 vertex indices per
+//triangle, uvs 2 floats per vertex, every triangle corner gets the offset of
+//its vertex uv. A vertex is shared by about 6 corners, so the batch kernel
+//runs once over the vertex buffer and the corners are gathered from the
+//result, what is left is making the gathers hit the cache, which is up to
+//how the mesh is laid out in memory. On a shuffled mesh visiting the
+//triangles in a better order is not enough, the index buffer reads become
+//the scattered ones, the mesh has to be rewritten once with reorderUVMesh
+//(about 7x less time per corner on a 16M vertex grid, see kernelBench)
+
+//visits the triangles in order[0, triangleCount), or in memory order when
+//order is null. The output follows the visit: the corners of the k-th
+//visited triangle go to offset_uv[6*k + 2*corner], so writes stay sequential.
+//order is for callers that want the corners in a given order, it does not
+//help the gathers, memory order is the fastest visit of a given mesh.
+//vertexCount is the number of pairs in uvs, they all get offset in a
+//temporary buffer
+void offsetMeshUVs(const uint32_t* indices, size_t triangleCount, const float* uvs,
+                   size_t vertexCount, const uint32_t* order, float* offset_uv);
+
+//per mesh offset and double precision, the vertices go through the matching
+//offsetUVsBatch overload, same results as offsetUVsNoBranch with
+//UVOffsets(offset) on every corner
+void offsetMeshUVs(const uint32_t* indices, size_t triangleCount, const float* uvs,
+                   size_t vertexCount, const uint32_t* order, float* offset_uv,
+                   float offset);
+void offsetMeshUVs(const uint32_t* indices, size_t triangleCount, const double* uvs,
+                   size_t vertexCount, const uint32_t* order, double* offset_uv,
+                   double offset);
+
+//same with a caller owned temporary buffer of 2*vertexCount values, nothing
+//gets allocated, for meshes processed over and over. scratch must not overlap
+//uvs or offset_uv, it is left holding the offset vertex uvs
+void offsetMeshUVs(const uint32_t* indices, size_t triangleCount, const float* uvs,
+                   size_t vertexCount, const uint32_t* order, float* offset_uv,
+                   float offset, float* scratch);
+void offsetMeshUVs(const uint32_t* indices, size_t triangleCount, const double* uvs,
+                   size_t vertexCount, const uint32_t* order, double* offset_uv,
+                   double offset, double* scratch);
+
+//triangle order following a morton curve over the uv centroids, meant as the
+//order given to reorderUVMesh. Passed straight to offsetMeshUVs it is slower
+//than memory order even on a shuffled mesh, the index reads get scattered
+//(about 10ns against 4.7ns per corner on a 16M vertex grid)
+void mortonTriangleOrder(const uint32_t* indices, size_t triangleCount, const float* uvs,
+                         uint32_t* order);
+
+//one time reordering for meshes that get processed many times: the triangles
+//are written in order and the vertices renumbered in first use order, after
+//that offsetMeshUVs on the new mesh with a null order reads both buffers
+//nearly sequentially. Unused vertices go at the end. Output triangle k is
+//input triangle order[k]
+void reorderUVMesh(const uint32_t* indices, size_t triangleCount, const float* uvs,
+                   size_t vertexCount, const uint32_t* order,
+                   uint32_t* newIndices, float* newUVs);
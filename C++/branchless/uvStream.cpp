@@ -0,0 +1,237 @@
+#include "uvStream.h"
+#include "uvBatch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#if defined(__linux__)
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__linux__)
+namespace
+{
+
+bool fail(std::string* error, const std::string& what, const char* path)
+{
+    if (error)
+    {
+        *error = what + " " + path + ": " + std::strerror(errno);
+    }
+    return false;
+}
+
+//closes and unmaps whatever got opened, on every return path
+struct MappedFile
+{
+    int fd = -1;
+    void* data = MAP_FAILED;
+    size_t size = 0;
+
+    ~MappedFile()
+    {
+        if (data != MAP_FAILED)
+        {
+            munmap(data, size);
+        }
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+    }
+};
+
+}
+
+bool offsetUVFile(const char* inputPath, const char* outputPath,
+                  const UVStreamOptions& options, UVStreamStats* stats, std::string* error)
+{
+    auto start = std::chrono::steady_clock::now();
+    const size_t page = size_t(sysconf(_SC_PAGESIZE));
+    const size_t chunkBytes = std::max(page, (options.chunkBytes + page - 1) / page * page);
+
+    MappedFile input;
+    input.fd = open(inputPath, O_RDONLY);
+    if (input.fd < 0)
+    {
+        return fail(error, "can not open", inputPath);
+    }
+    struct stat info;
+    if (fstat(input.fd, &info) != 0)
+    {
+        return fail(error, "can not stat", inputPath);
+    }
+    input.size = size_t(info.st_size);
+    if (input.size % (2*sizeof(float)) != 0)
+    {
+        errno = EINVAL;
+        return fail(error, "not a whole number of uv pairs in", inputPath);
+    }
+
+    //no O_TRUNC, the output may be the input under another name and is only
+    //cut once that is ruled out
+    MappedFile output;
+    output.fd = open(outputPath, O_RDWR | O_CREAT, 0644);
+    if (output.fd < 0)
+    {
+        return fail(error, "can not create", outputPath);
+    }
+    struct stat outputInfo;
+    if (fstat(output.fd, &outputInfo) != 0)
+    {
+        return fail(error, "can not stat", outputPath);
+    }
+    if (outputInfo.st_dev == info.st_dev && outputInfo.st_ino == info.st_ino)
+    {
+        errno = EINVAL;
+        return fail(error, "the output is the input,", outputPath);
+    }
+    output.size = input.size;
+    if (ftruncate(output.fd, off_t(output.size)) != 0)
+    {
+        return fail(error, "can not resize", outputPath);
+    }
+    //the blocks are reserved up front, a sparse output running out of disk
+    //would only show up as a SIGBUS on a store into the mapping
+    if (output.size > 0)
+    {
+        int result = posix_fallocate(output.fd, 0, off_t(output.size));
+        if (result != 0)
+        {
+            errno = result;
+            return fail(error, "can not allocate", outputPath);
+        }
+    }
+
+    UVStreamStats local;
+    local.pairs = input.size / (2*sizeof(float));
+    if (input.size == 0)
+    {
+        if (stats)
+        {
+            *stats = local;
+        }
+        return true;
+    }
+
+    input.data = mmap(nullptr, input.size, PROT_READ, MAP_SHARED, input.fd, 0);
+    if (input.data == MAP_FAILED)
+    {
+        return fail(error, "can not map", inputPath);
+    }
+    output.data = mmap(nullptr, output.size, PROT_READ | PROT_WRITE, MAP_SHARED, output.fd, 0);
+    if (output.data == MAP_FAILED)
+    {
+        return fail(error, "can not map", outputPath);
+    }
+    //only hints, a filesystem without huge page support just ignores them
+    madvise(input.data, input.size, MADV_SEQUENTIAL);
+    madvise(output.data, output.size, MADV_SEQUENTIAL);
+    madvise(input.data, input.size, MADV_HUGEPAGE);
+    madvise(output.data, output.size, MADV_HUGEPAGE);
+
+    const char* in = static_cast<const char*>(input.data);
+    char* out = static_cast<char*>(output.data);
+    const size_t chunks = (input.size + chunkBytes - 1) / chunkBytes;
+    const size_t depth = std::max<size_t>(options.prefetchChunks, 1);
+
+    //the helper faults chunk after chunk in and publishes how far it got, it
+    //never goes more than depth chunks past the kernel
+    std::atomic<size_t> prefetched{0};
+    std::atomic<size_t> processed{0};
+    std::thread helper([&]() {
+        volatile char sink = 0;
+        for (size_t chunk = 0; chunk < chunks; ++chunk)
+        {
+            for (size_t done = processed.load(std::memory_order_acquire); chunk >= done + depth;
+                 done = processed.load(std::memory_order_acquire))
+            {
+                processed.wait(done, std::memory_order_acquire);
+            }
+            const size_t begin = chunk * chunkBytes;
+            const size_t bytes = std::min(chunkBytes, input.size - begin);
+            madvise(const_cast<char*>(in) + begin, bytes, MADV_WILLNEED);
+            //touching a page of the output maps its page cache page, the
+            //kernel then only dirties it
+            for (size_t offset = 0; offset < bytes; offset += page)
+            {
+                sink = sink + in[begin + offset] + out[begin + offset];
+            }
+            prefetched.store(chunk + 1, std::memory_order_release);
+            prefetched.notify_one();
+        }
+    });
+
+    for (size_t chunk = 0; chunk < chunks; ++chunk)
+    {
+        auto waitStart = std::chrono::steady_clock::now();
+        for (size_t ready = prefetched.load(std::memory_order_acquire); ready <= chunk;
+             ready = prefetched.load(std::memory_order_acquire))
+        {
+            prefetched.wait(ready, std::memory_order_acquire);
+        }
+        local.waitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - waitStart).count();
+
+        const size_t begin = chunk * chunkBytes;
+        const size_t bytes = std::min(chunkBytes, input.size - begin);
+        offsetUVsBatch(reinterpret_cast<const float*>(in + begin), reinterpret_cast<float*>(out + begin),
+                       bytes / (2*sizeof(float)), options.offset);
+
+        //start writing the chunk back and let go of the previous one, the
+        //writeback had a whole chunk of time to finish
+        sync_file_range(output.fd, off_t(begin), off_t(bytes), SYNC_FILE_RANGE_WRITE);
+        if (options.dropProcessed && chunk > 0)
+        {
+            const size_t previous = begin - chunkBytes;
+            madvise(const_cast<char*>(in) + previous, chunkBytes, MADV_DONTNEED);
+            posix_fadvise(input.fd, off_t(previous), off_t(chunkBytes), POSIX_FADV_DONTNEED);
+            //fadvise can't evict pages that are still mapped or not written
+            //yet, without this the output mapping grows to the whole file.
+            //Waiting is cheap, the writeback was started a chunk ago
+            sync_file_range(output.fd, off_t(previous), off_t(chunkBytes),
+                            SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE |
+                            SYNC_FILE_RANGE_WAIT_AFTER);
+            madvise(out + previous, chunkBytes, MADV_DONTNEED);
+            posix_fadvise(output.fd, off_t(previous), off_t(chunkBytes), POSIX_FADV_DONTNEED);
+        }
+        processed.store(chunk + 1, std::memory_order_release);
+        processed.notify_one();
+    }
+    helper.join();
+
+    //sync_file_range above only started the writeback, a failed write is
+    //only reported here
+    if (msync(output.data, output.size, MS_SYNC) != 0)
+    {
+        return fail(error, "can not write back", outputPath);
+    }
+    if (fsync(output.fd) != 0)
+    {
+        return fail(error, "can not write back", outputPath);
+    }
+
+    local.chunks = chunks;
+    local.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (stats)
+    {
+        *stats = local;
+    }
+    return true;
+}
+#else
+bool offsetUVFile(const char*, const char*, const UVStreamOptions&, UVStreamStats*, std::string* error)
+{
+    if (error)
+    {
+        *error = "streaming needs mmap, only built for linux";
+    }
+    return false;
+}
+#endif
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+//streaming front end of the uv offset for dumps bigger than memory. The input
+//file is raw little endian float (u, v) pairs, the output file gets the
+//offset pairs in the same layout. Both are mmapped and walked in chunks, a
+//helper thread faults the next chunks in (input read ahead, output pages
+//allocated) while the batch kernel works on the current one, and chunks that
+//are done get written back and dropped from the page cache so the footprint
+//stays at a few chunks whatever the file size. Linux only, elsewhere it fails
+//with an error.
+
+struct UVStreamOptions
+{
+    //bytes per chunk, rounded up to the page size, the default is a huge page
+    size_t chunkBytes = size_t(2) << 20;
+    //chunks faulted in ahead of the kernel
+    size_t prefetchChunks = 4;
+    //offset of the smallest coordinate, see UVOffsets
+    float offset = 0.01f;
+    //drop the processed chunks from the page cache, off when the output is
+    //read right after
+    bool dropProcessed = true;
+};
+
+struct UVStreamStats
+{
+    uint64_t pairs = 0;
+    size_t chunks = 0;
+    double seconds = 0.0;
+    //time the kernel waited for the helper thread, close to seconds means
+    //the run was bound by the disk
+    double waitSeconds = 0.0;
+};
+
+//false with the reason in error when a file can not be opened, mapped, the
+//input size is not a whole number of pairs, both paths are the same file, or
+//the output can not be allocated or written back. True means the output is
+//on disk
+bool offsetUVFile(const char* inputPath, const char* outputPath,
+                  const UVStreamOptions& options, UVStreamStats* stats, std::string* error);
@@ -0,0 +1,97 @@
+//offsets a uv dump file into another one, see uvStream.h
+//
+//uvstream INPUT OUTPUT [--offset X] [--chunk-mb N] [--prefetch N] [--keep-cache]
+//uvstream --generate PAIRS OUTPUT
+//
+//built by the CMakeLists.txt in the C++ folder, target uvstream
+
+#include "uvStream.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+static int generate(unsigned long long pairs, const char* path)
+{
+    FILE* file = fopen(path, "wb");
+    if (!file)
+    {
+        fprintf(stderr, "can not create %s\n", path);
+        return 1;
+    }
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<float> block(1 << 20);
+    for (unsigned long long written = 0; written < pairs;)
+    {
+        size_t count = size_t(std::min<unsigned long long>(block.size() / 2, pairs - written));
+        for (size_t i = 0; i < 2*count; ++i)
+        {
+            block[i] = unit(rng);
+        }
+        if (fwrite(block.data(), 2*sizeof(float), count, file) != count)
+        {
+            fprintf(stderr, "can not write %s\n", path);
+            fclose(file);
+            return 1;
+        }
+        written += count;
+    }
+    fclose(file);
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc == 4 && strcmp(argv[1], "--generate") == 0)
+    {
+        return generate(strtoull(argv[2], nullptr, 10), argv[3]);
+    }
+    if (argc < 3)
+    {
+        fprintf(stderr, "uvstream INPUT OUTPUT [--offset X] [--chunk-mb N] [--prefetch N] [--keep-cache]\n"
+                        "uvstream --generate PAIRS OUTPUT\n");
+        return 1;
+    }
+
+    UVStreamOptions options;
+    for (int i = 3; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--keep-cache") == 0)
+        {
+            options.dropProcessed = false;
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--offset") == 0)
+        {
+            options.offset = strtof(argv[++i], nullptr);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--chunk-mb") == 0)
+        {
+            options.chunkBytes = size_t(strtoull(argv[++i], nullptr, 10)) << 20;
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--prefetch") == 0)
+        {
+            options.prefetchChunks = size_t(strtoull(argv[++i], nullptr, 10));
+        }
+        else
+        {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    UVStreamStats stats;
+    std::string error;
+    if (!offsetUVFile(argv[1], argv[2], options, &stats, &error))
+    {
+        fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    double gb = double(stats.pairs) * 2 * sizeof(float) / 1e9;
+    printf("%llu pairs in %zu chunks, %.3f s, %.2f GB/s read, kernel waited %.3f s\n",
+           (unsigned long long)stats.pairs, stats.chunks, stats.seconds,
+           stats.seconds > 0.0 ? gb / stats.seconds : 0.0, stats.waitSeconds);
+    return 0;
+}
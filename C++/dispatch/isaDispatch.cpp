@@ -0,0 +1,64 @@
+#include "isaDispatch.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace dispatch {
+
+static Isa hardwareIsa() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  __builtin_cpu_init();
+  // lzcnt is not exposed by __builtin_cpu_supports, every cpu with bmi2
+  // has it so we use that as proxy
+  bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2");
+  bool avx512 = avx2 && __builtin_cpu_supports("avx512f") &&
+                __builtin_cpu_supports("avx512vl") &&
+                __builtin_cpu_supports("avx512bw") &&
+                __builtin_cpu_supports("avx512dq");
+  return avx512 ? Isa::Avx512 : (avx2 ? Isa::Avx2 : Isa::Scalar);
+#else
+  return Isa::Scalar;
+#endif
+}
+
+static Isa computeIsa() {
+  Isa best = hardwareIsa();
+  const char *forced = std::getenv("KERNELS_ISA");
+  if (forced == nullptr) {
+    return best;
+  }
+  Isa requested = best;
+  if (std::strcmp(forced, "scalar") == 0) {
+    requested = Isa::Scalar;
+  } else if (std::strcmp(forced, "avx2") == 0) {
+    requested = Isa::Avx2;
+  } else if (std::strcmp(forced, "avx512") == 0) {
+    requested = Isa::Avx512;
+  }
+  // never go above what the hardware can do
+  return static_cast<int>(requested) < static_cast<int>(best) ? requested
+                                                              : best;
+}
+
+Isa detectIsa() {
+  static const Isa isa = computeIsa();
+  return isa;
+}
+
+bool isaSupported(Isa isa) {
+  static const Isa best = hardwareIsa();
+  return static_cast<int>(isa) <= static_cast<int>(best);
+}
+
+const char *isaName(Isa isa) {
+  switch (isa) {
+  case Isa::Avx512:
+    return "avx512";
+  case Isa::Avx2:
+    return "avx2";
+  default:
+    return "scalar";
+  }
+}
+
+} // namespace dispatch
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+
+// Runtime selection of the kernel implementations. The kernel libraries are
+// compiled once per instruction set, every object gets KERNEL_ISA_SUFFIX
+// defined by the build (Scalar, Avx2 or Avx512) and uses KERNEL_ISA_NAME to
+// give its functions a unique name, the dispatcher then picks the best one
+// the cpu supports.
+
+#define KERNEL_ISA_CONCAT_IMPL(a, b) a##b
+#define KERNEL_ISA_CONCAT(a, b) KERNEL_ISA_CONCAT_IMPL(a, b)
+#define KERNEL_ISA_NAME(name) KERNEL_ISA_CONCAT(name, KERNEL_ISA_SUFFIX)
+
+// The inline kernels of the headers (floatingPointSoftware.h, swFloat8.h,
+// uv.h) are compiled with the flags of every object that includes them. The
+// headers put them between KERNEL_ISA_NAMESPACE_BEGIN and _END, in a
+// namespace named after the instruction set the object is built for
+// (isaScalar, isaAvx2, isaAvx512), so an out of line copy built for avx2 is
+// never the one the linker keeps for a scalar caller. The objects that are
+// not multiversioned get the name of the flags they are built with, the
+// targets built for avx2 use the same flags as the Avx2 kernels. A using
+// directive keeps the unqualified names working
+#if defined(KERNEL_ISA_SUFFIX)
+#define KERNEL_ISA_NAMESPACE KERNEL_ISA_NAME(isa)
+#elif defined(__AVX512F__)
+#define KERNEL_ISA_NAMESPACE isaAvx512
+#elif defined(__AVX2__)
+#define KERNEL_ISA_NAMESPACE isaAvx2
+#else
+#define KERNEL_ISA_NAMESPACE isaScalar
+#endif
+#define KERNEL_ISA_NAMESPACE_BEGIN namespace KERNEL_ISA_NAMESPACE {
+#define KERNEL_ISA_NAMESPACE_END                                               \
+  }                                                                            \
+  using namespace KERNEL_ISA_NAMESPACE;
+
+namespace dispatch {
+
+enum class Isa { Scalar = 0, Avx2 = 1, Avx512 = 2 };
+
+// best instruction set of the machine, the KERNELS_ISA environment variable
+// (scalar, avx2, avx512) can force a lower one, the value is computed once
+Isa detectIsa();
+bool isaSupported(Isa isa);
+const char *isaName(Isa isa);
+
+template <typename Function>
+Function selectKernel(Function scalar, Function avx2, Function avx512) {
+  switch (detectIsa()) {
+  case Isa::Avx512:
+    return avx512;
+  case Isa::Avx2:
+    return avx2;
+  default:
+    return scalar;
+  }
+}
+
+} // namespace dispatch
@@ -0,0 +1,156 @@
+#include "exactAccumulator.h"
+#include "../dispatch/isaDispatch.h"
+#include "../instrumentation/instrumentation.h"
+#include "floatingPointSoftware.h"
+
+#include <cmath>
+#include <cstring>
+
+// the digits take 2^31 terms before overflowing, the carries are resolved a
+// good margin before that, and calls are split in chunks of half of it
+static const uint64_t PENDING_LIMIT = uint64_t(1) << 30;
+static const size_t CHUNK = size_t(1) << 29;
+
+void ExactAccumulator::add(float value) { addSum(&value, 1); }
+
+void ExactAccumulator::addProduct(float a, float b) { addDot(&a, &b, 1); }
+
+void ExactAccumulator::addSum(const float *values, size_t count) {
+  static const auto kernel = dispatch::selectKernel(
+      exactSumAccumulateScalar, exactSumAccumulateAvx2,
+      exactSumAccumulateAvx512);
+  for (size_t done = 0; done < count; done += CHUNK) {
+    size_t chunk = count - done < CHUNK ? count - done : CHUNK;
+    reserve(chunk);
+    m_special += kernel(m_digits, values + done, chunk);
+    m_pending += chunk;
+  }
+}
+
+void ExactAccumulator::addDot(const float *a, const float *b, size_t count) {
+  static const auto kernel = dispatch::selectKernel(
+      exactDotAccumulateScalar, exactDotAccumulateAvx2,
+      exactDotAccumulateAvx512);
+  for (size_t done = 0; done < count; done += CHUNK) {
+    size_t chunk = count - done < CHUNK ? count - done : CHUNK;
+    reserve(chunk);
+    m_special += kernel(m_digits, a + done, b + done, chunk);
+    m_pending += chunk;
+  }
+}
+
+void ExactAccumulator::merge(const ExactAccumulator &other) {
+  ExactAccumulator carried = other;
+  carried.normalize();
+  normalize();
+  for (size_t i = 0; i < DIGITS; ++i) {
+    m_digits[i] += carried.m_digits[i];
+  }
+  // every digit got two normalized values, like two terms
+  m_pending = 2;
+  m_special += other.m_special;
+}
+
+void ExactAccumulator::clear() { *this = ExactAccumulator(); }
+
+void ExactAccumulator::reserve(size_t count) {
+  if (m_pending + count > PENDING_LIMIT) {
+    normalize();
+  }
+}
+
+// moves the carries up, every digit but the top one ends up in [0, 2^32),
+// the top one keeps the sign of the whole number
+void ExactAccumulator::normalize() {
+  int64_t carry = 0;
+  for (size_t i = 0; i + 1 < DIGITS; ++i) {
+    int64_t value = m_digits[i] + carry;
+    m_digits[i] = value & 0xFFFFFFFF;
+    carry = value >> 32;
+  }
+  m_digits[DIGITS - 1] += carry;
+  m_pending = 0;
+}
+
+float ExactAccumulator::round() const {
+  // inf or nan, the finite part does not matter anymore
+  if (!std::isfinite(m_special)) {
+    return m_special;
+  }
+
+  ExactAccumulator copy = *this;
+  copy.normalize();
+  uint32_t digits[DIGITS];
+  for (size_t i = 0; i < DIGITS; ++i) {
+    digits[i] = static_cast<uint32_t>(copy.m_digits[i]);
+  }
+  // rounding to nearest is symmetric, the magnitude is rounded and the sign
+  // put back
+  uint32_t sign = copy.m_digits[DIGITS - 1] < 0 ? 1 : 0;
+  if (sign) {
+    uint64_t carry = 1;
+    for (size_t i = 0; i < DIGITS; ++i) {
+      uint64_t value = uint64_t(~digits[i]) + carry;
+      digits[i] = static_cast<uint32_t>(value);
+      carry = value >> 32;
+    }
+  }
+
+  int top = static_cast<int>(DIGITS) - 1;
+  while (top >= 0 && digits[top] == 0) {
+    --top;
+  }
+  if (top < 0) {
+    return 0.0f;
+  }
+  auto digitAt = [&digits](int index) -> uint64_t {
+    return index < static_cast<int>(DIGITS) ? digits[index] : 0;
+  };
+  auto bitAt = [&digits](int position) -> uint32_t {
+    return (digits[position >> 5] >> (position & 31)) & 1;
+  };
+
+  const int highest = 32 * top + static_cast<int>(findHighestBit(digits[top]));
+  // lowest bit kept, 24 bits for the normals, the denormals stop at 2^-149
+  const int denormalLimit = POINT - 149;
+  const int lowest =
+      highest - 23 > denormalLimit ? highest - 23 : denormalLimit;
+  const int exponent = highest - POINT + 127;
+  if (exponent >= 255) {
+    return sign ? -INFINITY : INFINITY;
+  }
+
+  uint64_t window =
+      digitAt(lowest >> 5) | (digitAt((lowest >> 5) + 1) << 32);
+  uint32_t mantissa = static_cast<uint32_t>(window >> (lowest & 31)) &
+                      ((1u << 24) - 1);
+  uint32_t guard = bitAt(lowest - 1);
+  const int stickyTop = lowest - 1;
+  bool sticky = (digits[stickyTop >> 5] & ((1u << (stickyTop & 31)) - 1)) != 0;
+  for (int i = 0; i < (stickyTop >> 5) && !sticky; ++i) {
+    sticky = digits[i] != 0;
+  }
+
+  // the hidden one lands on the exponent field and adds the missing one,
+  // a rounding carry moves into the exponent and up to inf as it should
+  uint32_t bits = (exponent > 0 ? uint32_t(exponent - 1) << 23 : 0) + mantissa;
+  bits += guard & (uint32_t(sticky) | (mantissa & 1));
+  bits |= sign << 31;
+  float result;
+  std::memcpy(&result, &bits, sizeof(result));
+  return result;
+}
+
+float exactSum(const float *values, size_t count) {
+  KERNELS_TRACE_SCOPE("exactSum");
+  ExactAccumulator accumulator;
+  accumulator.addSum(values, count);
+  return accumulator.round();
+}
+
+float exactDot(const float *a, const float *b, size_t count) {
+  KERNELS_TRACE_SCOPE("exactDot");
+  ExactAccumulator accumulator;
+  accumulator.addDot(a, b, count);
+  return accumulator.round();
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Exact sums and dot products of floats, Kulisch style. Every float is
+// decomposed in its 24 bits mantissa and its exponent (the same split the
+// soft float works on), a product of two of them is a 48 bits integer times
+// a power of two, and it is added as an integer into a fixed point
+// accumulator wide enough to hold any product of two floats, from the
+// smallest denormal squared (2^-298) to the largest float squared, plus 64
+// bits of headroom for the carries. Nothing is ever rounded until round(),
+// which gives the correctly rounded (nearest even) float of the exact
+// result, regardless of the order of the terms or of cancellations.
+//
+// The accumulator is carry save: DIGITS signed 64 bits words each holding
+// 32 bits of the number, an added term touches at most 3 of them and never
+// propagates a carry. The words have room for 2^31 terms, the carries are
+// resolved every 2^30 terms and when rounding.
+//
+// inf and nan follow the hardware: they are summed in a plain float on the
+// side and returned as the result when present. An exact zero is +0.
+class ExactAccumulator {
+public:
+  static const size_t DIGITS = 20;
+  // bit of the accumulator holding 2^0
+  static const int POINT = 298;
+
+  void add(float value);
+  void addProduct(float a, float b);
+  // sum of values[i], dot product of a and b, the bulk versions use the
+  // best instruction set of the cpu, the results don't depend on it
+  void addSum(const float *values, size_t count);
+  void addDot(const float *a, const float *b, size_t count);
+  // adds what other accumulated, partial sums of different threads can be
+  // merged without losing anything
+  void merge(const ExactAccumulator &other);
+
+  float round() const;
+  void clear();
+
+private:
+  // resolves the pending carries if count more terms could overflow a word
+  void reserve(size_t count);
+  void normalize();
+
+  int64_t m_digits[DIGITS] = {};
+  uint64_t m_pending = 0;
+  float m_special = 0.0f;
+};
+
+// correctly rounded sum and dot product
+float exactSum(const float *values, size_t count);
+float exactDot(const float *a, const float *b, size_t count);
+
+// single instruction set versions of the accumulation, they add count terms
+// to the digits without resolving the carries and return the hardware sum of
+// the terms involving inf or nan (0 when there are none)
+#define EXACT_ACCUMULATE_DECLARE(SUFFIX)                                       \
+  float exactSumAccumulate##SUFFIX(int64_t *digits, const float *values,       \
+                                   size_t count);                              \
+  float exactDotAccumulate##SUFFIX(int64_t *digits, const float *a,            \
+                                   const float *b, size_t count);
+
+EXACT_ACCUMULATE_DECLARE(Scalar)
+EXACT_ACCUMULATE_DECLARE(Avx2)
+EXACT_ACCUMULATE_DECLARE(Avx512)
@@ -0,0 +1,254 @@
+// compiled once per instruction set, see isaDispatch.h
+
+#include "exactAccumulator.h"
+#include "../dispatch/isaDispatch.h"
+#include "floatingPointSoftware.h"
+
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// a float is mantissa * 2^(exponent - 150) with the biased exponent, the
+// denormals have no hidden one and the exponent of the smallest normals
+static inline uint32_t decodeMantissa(uint32_t bits) {
+  uint32_t hidden = swFloatExponentBits(bits) != 0 ? (1u << 23) : 0u;
+  return swFloatMantissaBits(bits) | hidden;
+}
+
+static inline uint32_t decodeExponent(uint32_t bits) {
+  uint32_t exponent = swFloatExponentBits(bits);
+  return exponent != 0 ? exponent : 1u;
+}
+
+// positions in the accumulator of the lowest bit of a term, for a single
+// float and for the product of two
+static const int SUM_POSITION = ExactAccumulator::POINT - 150;
+static const int DOT_POSITION = ExactAccumulator::POINT - 300;
+
+static inline uint32_t floatBits(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+// adds value * 2^position, the value has at most 48 bits so with the shift
+// inside the digit it spans 3 digits at most. Negative terms are subtracted
+// digit by digit, the carries are resolved later
+static inline void addTerm(int64_t *digits, uint64_t value, uint32_t position,
+                           uint32_t negative) {
+  const uint64_t low = 0xFFFFFFFFu;
+  uint32_t shift = position & 31;
+  int64_t d0 = static_cast<int64_t>((value << shift) & low);
+  int64_t d1 = static_cast<int64_t>((value >> (32 - shift)) & low);
+  // split in two so that a zero shift does not become a shift by 64
+  int64_t d2 = static_cast<int64_t>((value >> 1) >> (63 - shift));
+  int64_t sign = -static_cast<int64_t>(negative);
+  int64_t *digit = digits + (position >> 5);
+  digit[0] += (d0 ^ sign) - sign;
+  digit[1] += (d1 ^ sign) - sign;
+  digit[2] += (d2 ^ sign) - sign;
+}
+
+static float sumTail(int64_t *digits, const float *values, size_t count) {
+  float special = 0.0f;
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t bits = floatBits(values[i]);
+    if (swFloatExponentBits(bits) == 255) {
+      special += values[i];
+      continue;
+    }
+    addTerm(digits, decodeMantissa(bits),
+            static_cast<uint32_t>(int(decodeExponent(bits)) + SUM_POSITION),
+            swFloatSignBits(bits));
+  }
+  return special;
+}
+
+static float dotTail(int64_t *digits, const float *a, const float *b,
+                     size_t count) {
+  float special = 0.0f;
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t abits = floatBits(a[i]);
+    uint32_t bbits = floatBits(b[i]);
+    if (swFloatExponentBits(abits) == 255 || swFloatExponentBits(bbits) == 255) {
+      special += a[i] * b[i];
+      continue;
+    }
+    uint64_t product =
+        uint64_t(decodeMantissa(abits)) * uint64_t(decodeMantissa(bbits));
+    int position =
+        int(decodeExponent(abits) + decodeExponent(bbits)) + DOT_POSITION;
+    addTerm(digits, product, static_cast<uint32_t>(position),
+            swFloatSignBits(abits ^ bbits));
+  }
+  return special;
+}
+
+#if defined(__AVX2__)
+
+// the lanes add to 4 separate copies of the digits, consecutive terms
+// often hit the same digits and with a single copy every add waits for the
+// previous one to be stored
+typedef int64_t DigitBanks[4][ExactAccumulator::DIGITS];
+
+// 4 terms, the shifts and the negations in 64 bits lanes, only the adds to
+// the digits are scalar, they go to different places for every term
+static inline void addTerms4(DigitBanks &banks, __m256i value,
+                             __m128i position, __m128i negative) {
+  const __m256i low = _mm256_set1_epi64x(0xFFFFFFFF);
+  __m256i shift =
+      _mm256_cvtepu32_epi64(_mm_and_si128(position, _mm_set1_epi32(31)));
+  __m256i sign = _mm256_cvtepi32_epi64(negative);
+  // srlv gives zero for a shift of 64, no need for the split of addTerm
+  __m256i d0 = _mm256_and_si256(_mm256_sllv_epi64(value, shift), low);
+  __m256i d1 = _mm256_and_si256(
+      _mm256_srlv_epi64(value, _mm256_sub_epi64(_mm256_set1_epi64x(32), shift)),
+      low);
+  __m256i d2 =
+      _mm256_srlv_epi64(value, _mm256_sub_epi64(_mm256_set1_epi64x(64), shift));
+  d0 = _mm256_sub_epi64(_mm256_xor_si256(d0, sign), sign);
+  d1 = _mm256_sub_epi64(_mm256_xor_si256(d1, sign), sign);
+  d2 = _mm256_sub_epi64(_mm256_xor_si256(d2, sign), sign);
+
+  alignas(32) int64_t v0[4];
+  alignas(32) int64_t v1[4];
+  alignas(32) int64_t v2[4];
+  alignas(16) uint32_t index[4];
+  _mm256_store_si256(reinterpret_cast<__m256i *>(v0), d0);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(v1), d1);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(v2), d2);
+  _mm_store_si128(reinterpret_cast<__m128i *>(index),
+                  _mm_srli_epi32(position, 5));
+  for (int i = 0; i < 4; ++i) {
+    int64_t *digit = banks[i] + index[i];
+    digit[0] += v0[i];
+    digit[1] += v1[i];
+    digit[2] += v2[i];
+  }
+}
+
+static inline void foldBanks(int64_t *digits, const DigitBanks &banks) {
+  for (size_t i = 0; i < ExactAccumulator::DIGITS; ++i) {
+    digits[i] += banks[0][i] + banks[1][i] + banks[2][i] + banks[3][i];
+  }
+}
+
+static inline __m256i exponentBits8(__m256i bits) {
+  return _mm256_and_si256(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(0xFF));
+}
+
+static inline __m256i decodeMantissa8(__m256i bits, __m256i exponent) {
+  __m256i hidden = _mm256_andnot_si256(
+      _mm256_cmpeq_epi32(exponent, _mm256_setzero_si256()),
+      _mm256_set1_epi32(1 << 23));
+  return _mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x7FFFFF)),
+                         hidden);
+}
+
+static inline __m256i decodeExponent8(__m256i exponent) {
+  return _mm256_max_epi32(exponent, _mm256_set1_epi32(1));
+}
+
+// inf and nan lanes get a zero mantissa, they still go through the adds
+// harmlessly and are summed by the hardware on the side
+static inline int specialLanes(__m256i special) {
+  return _mm256_movemask_ps(_mm256_castsi256_ps(special));
+}
+
+#endif
+
+float KERNEL_ISA_NAME(exactSumAccumulate)(int64_t *digits, const float *values,
+                                          size_t count) {
+  size_t i = 0;
+  float special = 0.0f;
+#if defined(__AVX2__)
+  // short arrays go straight to the tail, zeroing and folding the
+  // banks would cost more than the few terms
+  if (count >= 8) {
+    const __m256i infinite = _mm256_set1_epi32(255);
+    DigitBanks banks = {};
+    for (; i + 8 <= count; i += 8) {
+      __m256i bits =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(values + i));
+      __m256i exponent = exponentBits8(bits);
+      __m256i isSpecial = _mm256_cmpeq_epi32(exponent, infinite);
+      __m256i mantissa =
+          _mm256_andnot_si256(isSpecial, decodeMantissa8(bits, exponent));
+      __m256i position = _mm256_add_epi32(decodeExponent8(exponent),
+                                          _mm256_set1_epi32(SUM_POSITION));
+      __m256i negative = _mm256_srai_epi32(bits, 31);
+
+      addTerms4(banks, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(mantissa)),
+                _mm256_castsi256_si128(position),
+                _mm256_castsi256_si128(negative));
+      addTerms4(banks,
+                _mm256_cvtepu32_epi64(_mm256_extracti128_si256(mantissa, 1)),
+                _mm256_extracti128_si256(position, 1),
+                _mm256_extracti128_si256(negative, 1));
+
+      int lanes = specialLanes(isSpecial);
+      for (int lane = 0; lanes != 0; ++lane, lanes >>= 1) {
+        if (lanes & 1) {
+          special += values[i + lane];
+        }
+      }
+    }
+    foldBanks(digits, banks);
+  }
+#endif
+  return special + sumTail(digits, values + i, count - i);
+}
+
+float KERNEL_ISA_NAME(exactDotAccumulate)(int64_t *digits, const float *a,
+                                          const float *b, size_t count) {
+  size_t i = 0;
+  float special = 0.0f;
+#if defined(__AVX2__)
+  if (count >= 8) {
+    const __m256i infinite = _mm256_set1_epi32(255);
+    DigitBanks banks = {};
+    for (; i + 8 <= count; i += 8) {
+      __m256i abits =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+      __m256i bbits =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+      __m256i aexponent = exponentBits8(abits);
+      __m256i bexponent = exponentBits8(bbits);
+      __m256i isSpecial =
+          _mm256_or_si256(_mm256_cmpeq_epi32(aexponent, infinite),
+                          _mm256_cmpeq_epi32(bexponent, infinite));
+      __m256i amantissa =
+          _mm256_andnot_si256(isSpecial, decodeMantissa8(abits, aexponent));
+      __m256i bmantissa = decodeMantissa8(bbits, bexponent);
+      __m256i position =
+          _mm256_add_epi32(_mm256_add_epi32(decodeExponent8(aexponent),
+                                            decodeExponent8(bexponent)),
+                           _mm256_set1_epi32(DOT_POSITION));
+      __m256i negative = _mm256_srai_epi32(_mm256_xor_si256(abits, bbits), 31);
+
+      // the 24 x 24 bits mantissa products, 4 per multiply
+      __m256i productLow = _mm256_mul_epu32(
+          _mm256_cvtepu32_epi64(_mm256_castsi256_si128(amantissa)),
+          _mm256_cvtepu32_epi64(_mm256_castsi256_si128(bmantissa)));
+      __m256i productHigh = _mm256_mul_epu32(
+          _mm256_cvtepu32_epi64(_mm256_extracti128_si256(amantissa, 1)),
+          _mm256_cvtepu32_epi64(_mm256_extracti128_si256(bmantissa, 1)));
+      addTerms4(banks, productLow, _mm256_castsi256_si128(position),
+                _mm256_castsi256_si128(negative));
+      addTerms4(banks, productHigh, _mm256_extracti128_si256(position, 1),
+                _mm256_extracti128_si256(negative, 1));
+
+      int lanes = specialLanes(isSpecial);
+      for (int lane = 0; lanes != 0; ++lane, lanes >>= 1) {
+        if (lanes & 1) {
+          special += a[i + lane] * b[i + lane];
+        }
+      }
+    }
+    foldBanks(digits, banks);
+  }
+#endif
+  return special + dotTail(digits, a + i, b + i, count - i);
+}
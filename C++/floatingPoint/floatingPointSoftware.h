@@ -1,20 +1,34 @@
 #pragma once
 
+#include <array>
 #include <bitset>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <iostream>
+#include "../dispatch/isaDispatch.h"
+#include "../instrumentation/instrumentation.h"
+#if defined(__has_include)
+#if __has_include(<bit>)
+#include <bit>
+#endif
+#endif
 
 #ifdef MSVC
 #include <intrin.h>
 #endif
-#ifdef CLANG
+#if defined(__LZCNT__) && !defined(MSVC)
 #include <x86intrin.h>
 #endif
 
+// the kernels below are compiled once per instruction set, see isaDispatch.h
+KERNEL_ISA_NAMESPACE_BEGIN
+
 /**
  * Struct that allows us to easily access the different parts of the floating
- * point
+ * point. It also works as a value type, the operators at the end of the
+ * runtime section go through the soft float, so templated numeric code can
+ * be instantiated with it (and with SWFloat8, see swFloat8.h)
  */
 union SWFloat {
   struct {
@@ -23,15 +37,49 @@ union SWFloat {
     uint32_t sign : 1;
   };
   float original;
+
+  SWFloat() = default;
+  constexpr SWFloat(float value) : original(value) {}
+  explicit operator float() const { return original; }
 };
 
+// constexpr version of the bit scan, it is a branchless binary search on the
+// halves of the number, the result mimics 31 - lzcnt, meaning that for zero
+// we get 31 - 32 which wraps to 0xFFFFFFFF, this is important to keep the
+// results bit identical with the intrinsic based version
+constexpr uint32_t findHighestBitConstExpr(uint32_t v) {
+  uint32_t r = 0;
+  uint32_t t = v;
+  uint32_t step = (t >= (1u << 16)) ? 16u : 0u;
+  t >>= step;
+  r += step;
+  step = (t >= (1u << 8)) ? 8u : 0u;
+  t >>= step;
+  r += step;
+  step = (t >= (1u << 4)) ? 4u : 0u;
+  t >>= step;
+  r += step;
+  step = (t >= (1u << 2)) ? 2u : 0u;
+  t >>= step;
+  r += step;
+  step = (t >= (1u << 1)) ? 1u : 0u;
+  r += step;
+  // r is 0 for zero, or-ing the mask rather than selecting, gcc makes an early
+  // return out of the select
+  return r | (0u - static_cast<uint32_t>(v == 0));
+}
+
 inline uint32_t findHighestBit(uint32_t v) {
 #ifdef MSVC
   return 31 - __lzcnt(v);
 #endif
-#ifdef CLANG
+#if defined(__LZCNT__) && !defined(MSVC)
   return 31 - _lzcnt_u32(v);
 #endif
+#if !defined(MSVC) && !defined(__LZCNT__)
+  // portable fallback, same results as the lzcnt path
+  return findHighestBitConstExpr(v);
+#endif
 }
 
 
@@ -60,7 +108,7 @@ inline uint32_t findHighestBitLeft(uint32_t v) {
   return r;
 }
 
-std::ostream &operator<<(std::ostream &os, const SWFloat &ff) {
+inline std::ostream &operator<<(std::ostream &os, const SWFloat &ff) {
   os << std::bitset<1>(ff.sign) << "-" << std::bitset<8>(ff.exponent) << "-"
      << std::bitset<23>(ff.mantissa);
   return os;
@@ -118,16 +166,22 @@ inline uint32_t normalize32BitMantissaInPlace(uint32_t &mantissa) {
 
   // need to be really careful here or MSVC won't generate instructions
   // conditional move, if here i use mantissa rather than tempMantissa it
-  // wont work, clang is fine
-  mantissa = bit > 23 ? 0 : tempMantissa;
-  uint32_t returnValue = bit > 23 ? DENORMAL : bit;
+  // wont work, clang is fine. gcc 12 turned the ternaries into jumps anyway
+  // so the selects are done with masks, codegenCheck.sh keeps an eye on it
+  uint32_t outOfRange = 0u - static_cast<uint32_t>(bit > 23);
+  mantissa = tempMantissa & ~outOfRange;
+  uint32_t returnValue =
+      (DENORMAL & outOfRange) | (static_cast<uint32_t>(bit) & ~outOfRange);
   // at this point instead we have a good value to normalize
   // we shift left or right based on where the bit is
 
-  uint32_t mantissaLeft = mantissa << bit;
+  // both shifts are computed and one is picked, the masking keeps the unused
+  // one well defined, it is free since x86 shifts mask the count anyway
+  uint32_t mantissaLeft = mantissa << (bit & 31);
   uint32_t mantissaRight = mantissa >> abs(bit);
 
-  mantissa = (bit > 0) & (bit < 23) ? mantissaLeft : mantissaRight;
+  uint32_t useLeft = 0u - static_cast<uint32_t>((bit > 0) & (bit < 23));
+  mantissa = (mantissaLeft & useLeft) | (mantissaRight & ~useLeft);
   mantissa |= sticky;
   return returnValue;
 }
@@ -139,12 +193,12 @@ inline uint32_t insertHiddenOne(SWFloat value) {
   return (mantissa |= (1 << 23));
 }
 
-inline uint32_t extendStickyGRSbits(uint32_t mantissa) { return mantissa << 3; }
-inline uint64_t extendStickyGRSbits(uint64_t mantissa) { return mantissa << 3; }
+constexpr uint32_t extendStickyGRSbits(uint32_t mantissa) { return mantissa << 3; }
+constexpr uint64_t extendStickyGRSbits(uint64_t mantissa) { return mantissa << 3; }
 
-inline uint32_t extractGRSbits(uint32_t mantissa) { return mantissa & 7u; }
+constexpr uint32_t extractGRSbits(uint32_t mantissa) { return mantissa & 7u; }
 
-inline uint32_t roundMantissa(uint32_t mantissa) {
+constexpr uint32_t roundMantissa(uint32_t mantissa) {
   uint32_t grs = extractGRSbits(mantissa);
   // now that we extracted the values we can shift the mantissa by
   // the 3 extra bits
@@ -153,7 +207,7 @@ inline uint32_t roundMantissa(uint32_t mantissa) {
   // now if the grs  is equal to 100 base two, aka 4 base 10,
   // we need to check if we need to round up, this happens only
   // if the LSB of the mantissa is one, we extract that with cleanedMantissa &1
-  uint32_t toAdd = (grs == 4u) & (cleanedMantissa & 1) ? 1 : 0;
+  uint32_t toAdd = static_cast<uint32_t>(grs == 4u) & (cleanedMantissa & 1);
 
   // now we check just if the guard bit is one, and we did not already rounded
   // up thanks to the LSB we increase the rounding, this is basically computing
@@ -164,16 +218,14 @@ inline uint32_t roundMantissa(uint32_t mantissa) {
   // 4 in decimal, this mean only the 3rd bit will survive if set, the grs& 4u
   // operation will give us either a 4 or a 0. the second part we check if grs
   // is !=4 , meaning is not 100, because if so we alrady took care of it above
-  toAdd += (((grs & 4u) == 4) & (grs != 4)) ? 1 : 0;
-  // here we compute the mantissa if we have rounding, we are doing this
-  // explicitelly because otherwise MSVC creates a jump instead clang doesnt
+  toAdd += static_cast<uint32_t>(((grs & 4u) == 4) & (grs != 4));
+  // both checks need the guard bit, so toAdd is already zero without it. This
+  // used to be a conditional move on the guard bit, written explicitly
+  // because otherwise MSVC creates a jump instead clang doesnt
   // https://godbolt.org/g/StQajo
-  uint32_t mantissaIf4u = cleanedMantissa + toAdd;
-
-  // condtitional move based on guard bit
-
-  cleanedMantissa = (grs & 4u) ? mantissaIf4u : cleanedMantissa;
-  return cleanedMantissa;
+  // but gcc 12 made jumps out of it and out of the ternaries above, adding
+  // the flags as integers leaves nothing to branch on, see codegenCheck.sh
+  return cleanedMantissa + toAdd;
 }
 
 inline int roundMantissaOneJump(int mantissa) {
@@ -213,7 +265,7 @@ inline int roundMantissaTwoJump(int mantissa) {
   return cleanedMantissa;
 }
 
-inline void shiftExponent(uint32_t &mantissa, uint32_t exponent) {
+constexpr void shiftExponent(uint32_t &mantissa, uint32_t exponent) {
   uint32_t sticky = 0;
 
   for (uint32_t i = 0; i < exponent; ++i) {
@@ -224,7 +276,7 @@ inline void shiftExponent(uint32_t &mantissa, uint32_t exponent) {
   }
 }
 
-inline void shiftExponent64(uint64_t &mantissa, int exponent) {
+constexpr void shiftExponent64(uint64_t &mantissa, int exponent) {
   uint64_t sticky = 0;
   for (int i = 0; i < exponent; ++i) {
     mantissa = mantissa >> 1;
@@ -242,6 +294,7 @@ inline uint32_t countMantissaBits(uint32_t mantissa) {
 }
 
 inline SWFloat swFloatAddition(SWFloat a, SWFloat b) {
+  KERNELS_COUNT(SoftFloatCalls);
 
   // the first step is to have both floating point on the
   // same exponents, once that is done we can perform the addition
@@ -270,8 +323,11 @@ inline SWFloat swFloatAddition(SWFloat a, SWFloat b) {
     // if the sign is the same we can just go ahead and perform the addition
     uint32_t addedMantissa = amantissa + bmantissa;
     int bit = normalize32BitMantissaInPlace(addedMantissa);
+    KERNELS_COUNT_N(SoftFloatRounding, extractGRSbits(addedMantissa) != 0);
     addedMantissa = roundMantissa(addedMantissa);
-    res.exponent = a.exponent - bit;
+    // if the rounding rippled all the way up the mantissa is 1 << 24, the
+    // stored bits are already zero we only need to bump the exponent
+    res.exponent = a.exponent - bit + (addedMantissa >> 24);
     res.mantissa = addedMantissa;
     res.sign = a.sign;
 
@@ -298,10 +354,13 @@ inline SWFloat swFloatAddition(SWFloat a, SWFloat b) {
 
     uint32_t unsignedMantissa = static_cast<uint32_t>(mantissa);
     int bit = normalize32BitMantissaInPlace(unsignedMantissa);
+    KERNELS_COUNT_N(SoftFloatDenormals, bit == DENORMAL);
+    KERNELS_COUNT_N(SoftFloatRounding, extractGRSbits(unsignedMantissa) != 0);
     unsignedMantissa = roundMantissa(unsignedMantissa);
     // checking for denormal
     sign = (bit == DENORMAL) ? 0 : sign;
-    exponent = (bit == DENORMAL) ? 0 : exponent - bit;
+    exponent = (bit == DENORMAL) ? 0
+                                 : exponent - bit + (unsignedMantissa >> 24);
 
     // returning the result
     res.exponent = exponent;
@@ -323,16 +382,20 @@ inline uint64_t simpleMultFaster64(uint32_t a, uint32_t b) {
   uint32_t bbit = (findHighestBit(b));
   uint64_t result = 0;
 
+  // the bit becomes an all ones or all zeros mask rather than a select, a
+  // profile guided build turned the select back into a branch on the bits of
+  // b, which mispredicts half the time and made the multiply 3x slower
   for (uint32_t bi = 0; bi <= bbit; ++bi) {
     uint64_t bmask = 1ll << bi;
     uint64_t bvalue = (bextend & bmask) >> bi;
-    result += bvalue ? aextend << bi : 0;
+    result += (aextend << bi) & (0 - bvalue);
   }
 
   return result;
 }
 
 SWFloat inline swFloatMultiplication(SWFloat a, SWFloat b) {
+  KERNELS_COUNT(SoftFloatCalls);
 
   uint32_t amantissa32 = insertHiddenOne(a);
   uint32_t bmantissa32 = insertHiddenOne(b);
@@ -349,6 +412,8 @@ SWFloat inline swFloatMultiplication(SWFloat a, SWFloat b) {
 
   // normalizing and rounding
   int bit = normalize32BitMantissaInPlace(manSticky32);
+  KERNELS_COUNT_N(SoftFloatDenormals, bit == DENORMAL);
+  KERNELS_COUNT_N(SoftFloatRounding, extractGRSbits(manSticky32) != 0);
   manSticky32 = roundMantissa(manSticky32);
   exponent -= bit;
 
@@ -369,6 +434,7 @@ SWFloat inline swFloatMultiplication(SWFloat a, SWFloat b) {
 }
 
 SWFloat inline swFloatDivision(SWFloat a, SWFloat b) {
+  KERNELS_COUNT(SoftFloatCalls);
 
   uint32_t amantissa = insertHiddenOne(a);
   uint32_t bmantissa = insertHiddenOne(b);
@@ -406,7 +472,9 @@ SWFloat inline swFloatDivision(SWFloat a, SWFloat b) {
       result = result << 1;
     }
 
-    uint32_t extractedIfPositive = (amantissa >> abs(startingIndex)) & 1;
+    // the count is masked so the value we throw away is still well defined
+    uint32_t extractedIfPositive =
+        (amantissa >> (abs(startingIndex) & 31)) & 1;
     uint32_t newExtracted = startingIndex >= 0 ? extractedIfPositive : 0;
     start = (start << 1) | newExtracted;
   }
@@ -421,6 +489,8 @@ SWFloat inline swFloatDivision(SWFloat a, SWFloat b) {
 
   int bit = normalize32BitMantissaInPlace(result32);
   exponent -= bit;
+  KERNELS_COUNT_N(SoftFloatDenormals, bit == DENORMAL);
+  KERNELS_COUNT_N(SoftFloatRounding, extractGRSbits(result32) != 0);
   result32 = roundMantissa(result32);
 
   SWFloat res;
@@ -429,3 +499,253 @@ SWFloat inline swFloatDivision(SWFloat a, SWFloat b) {
   res.mantissa = result32;
   return res;
 }
+
+// value type operators, a - b is a + (-b) and the negation only flips the
+// sign bit, so the results are the ones of the functions above
+inline SWFloat operator-(SWFloat a) {
+  a.sign = a.sign ^ 1;
+  return a;
+}
+inline SWFloat operator+(SWFloat a, SWFloat b) { return swFloatAddition(a, b); }
+inline SWFloat operator-(SWFloat a, SWFloat b) {
+  return swFloatAddition(a, -b);
+}
+inline SWFloat operator*(SWFloat a, SWFloat b) {
+  return swFloatMultiplication(a, b);
+}
+inline SWFloat operator/(SWFloat a, SWFloat b) { return swFloatDivision(a, b); }
+inline SWFloat &operator+=(SWFloat &a, SWFloat b) { return a = a + b; }
+inline SWFloat &operator-=(SWFloat &a, SWFloat b) { return a = a - b; }
+inline SWFloat &operator*=(SWFloat &a, SWFloat b) { return a = a * b; }
+inline SWFloat &operator/=(SWFloat &a, SWFloat b) { return a = a / b; }
+
+// comparisons are exact in hardware, no need to emulate them
+inline bool operator==(SWFloat a, SWFloat b) { return a.original == b.original; }
+inline bool operator!=(SWFloat a, SWFloat b) { return a.original != b.original; }
+inline bool operator<(SWFloat a, SWFloat b) { return a.original < b.original; }
+inline bool operator>(SWFloat a, SWFloat b) { return a.original > b.original; }
+inline bool operator<=(SWFloat a, SWFloat b) { return a.original <= b.original; }
+inline bool operator>=(SWFloat a, SWFloat b) { return a.original >= b.original; }
+
+inline SWFloat abs(SWFloat a) {
+  a.sign = 0;
+  return a;
+}
+
+// the scalar side of the SWFloat8 masks in swFloat8.h, so templated code
+// can pick and stop on conditions: a comparison gives a bool here and a mask
+// of lanes there. min and max keep the std::min and std::max answers for
+// nans and zeros of both signs
+inline SWFloat select(bool condition, SWFloat a, SWFloat b) {
+  return condition ? a : b;
+}
+inline SWFloat min(SWFloat a, SWFloat b) { return select(b < a, b, a); }
+inline SWFloat max(SWFloat a, SWFloat b) { return select(a < b, b, a); }
+inline bool anyLane(bool condition) { return condition; }
+inline bool allLanes(bool condition) { return condition; }
+
+// Compile time soft float
+// the functions above can't be constexpr due to the union type punning and
+// the lzcnt intrinsics, the following versions work directly on the raw 32
+// bits of the float and use the constexpr bit scan, they follow step by step
+// the runtime implementation so that the results are bit identical, meaning
+// we can bake lookup tables in the binary rather than generating them at
+// startup
+
+constexpr uint32_t swFloatSignBits(uint32_t value) { return value >> 31; }
+constexpr uint32_t swFloatExponentBits(uint32_t value) {
+  return (value >> 23) & 0xFFu;
+}
+constexpr uint32_t swFloatMantissaBits(uint32_t value) {
+  return value & ((1u << 23) - 1);
+}
+
+// packs the different parts of the float the same way assigning to the
+// bitfields of SWFloat would, values get truncated to the field size
+constexpr uint32_t swFloatPackBits(uint32_t sign, uint32_t exponent,
+                                   uint32_t mantissa) {
+  return ((sign & 1u) << 31) | ((exponent & 0xFFu) << 23) |
+         swFloatMantissaBits(mantissa);
+}
+
+constexpr uint32_t insertHiddenOneConstExpr(uint32_t value) {
+  return swFloatMantissaBits(value) | (1u << 23);
+}
+
+constexpr uint32_t normalize32BitMantissaInPlaceConstExpr(uint32_t &mantissa) {
+  uint32_t tempMantissa = mantissa;
+  uint32_t sticky = mantissa & 1;
+  int bit = 26 - static_cast<int>(findHighestBitConstExpr(tempMantissa));
+
+  mantissa = bit > 23 ? 0 : tempMantissa;
+  uint32_t returnValue = bit > 23 ? DENORMAL : bit;
+
+  // at runtime both shifts are computed and the right one is picked with a
+  // conditional move, here we can't, an out of range shift is not allowed
+  // in a constant expression so we only evaluate the one we need
+  uint32_t absBit = bit < 0 ? static_cast<uint32_t>(-bit) : bit;
+  mantissa = (bit > 0) & (bit < 23) ? mantissa << bit : mantissa >> absBit;
+  mantissa |= sticky;
+  return returnValue;
+}
+
+constexpr uint32_t countMantissaBitsConstExpr(uint32_t mantissa) {
+  while (!(mantissa & 1)) {
+    mantissa = mantissa >> 1;
+  }
+  return findHighestBitConstExpr(mantissa);
+}
+
+constexpr uint32_t swFloatAdditionBitsConstExpr(uint32_t a, uint32_t b) {
+  uint32_t aSign = swFloatSignBits(a);
+  uint32_t bSign = swFloatSignBits(b);
+  uint32_t aExponent = swFloatExponentBits(a);
+  uint32_t bExponent = swFloatExponentBits(b);
+  int deltaExponent = int(aExponent) - int(bExponent);
+
+  uint32_t amantissa = extendStickyGRSbits(insertHiddenOneConstExpr(a));
+  uint32_t bmantissa = extendStickyGRSbits(insertHiddenOneConstExpr(b));
+
+  if (deltaExponent < 0) {
+    aExponent = aExponent + static_cast<uint32_t>(-deltaExponent);
+    shiftExponent(amantissa, static_cast<uint32_t>(-deltaExponent));
+  } else {
+    bExponent = bExponent + static_cast<uint32_t>(deltaExponent);
+    shiftExponent(bmantissa, static_cast<uint32_t>(deltaExponent));
+  }
+
+  if (bSign == aSign) {
+    uint32_t addedMantissa = amantissa + bmantissa;
+    int bit = normalize32BitMantissaInPlaceConstExpr(addedMantissa);
+    addedMantissa = roundMantissa(addedMantissa);
+    return swFloatPackBits(aSign, aExponent - bit + (addedMantissa >> 24),
+                           addedMantissa);
+  }
+
+  int sign = 0;
+  int exponent = aExponent;
+  int negativeA = static_cast<int>(bmantissa - amantissa);
+  int negativeB = static_cast<int>(amantissa - bmantissa);
+  int mantissa = aSign != 0 ? negativeA : negativeB;
+
+  bool shouldFlip = mantissa < 0;
+  mantissa = shouldFlip ? -mantissa : mantissa;
+  sign = shouldFlip ? 1 : sign;
+
+  uint32_t unsignedMantissa = static_cast<uint32_t>(mantissa);
+  int bit = normalize32BitMantissaInPlaceConstExpr(unsignedMantissa);
+  unsignedMantissa = roundMantissa(unsignedMantissa);
+  sign = (bit == DENORMAL) ? 0 : sign;
+  exponent =
+      (bit == DENORMAL) ? 0 : exponent - bit + int(unsignedMantissa >> 24);
+  return swFloatPackBits(sign, exponent, unsignedMantissa);
+}
+
+constexpr uint32_t swFloatMultiplicationBitsConstExpr(uint32_t a, uint32_t b) {
+  uint32_t amantissa32 = insertHiddenOneConstExpr(a);
+  uint32_t bmantissa32 = insertHiddenOneConstExpr(b);
+
+  int aexp = int(swFloatExponentBits(a)) - 127;
+  int bexp = int(swFloatExponentBits(b)) - 127;
+  int exponent = (aexp + bexp) + 127;
+
+  // simpleMultFaster64 computes the exact 48 bit product, we can directly
+  // use the 64 bit multiplication and get the same bits
+  uint64_t mantissaMult = static_cast<uint64_t>(amantissa32) * bmantissa32;
+  uint64_t manSticky = extendStickyGRSbits(mantissaMult);
+  shiftExponent64(manSticky, 46 - 23);
+
+  uint32_t manSticky32 = static_cast<uint32_t>(manSticky);
+
+  int bit = normalize32BitMantissaInPlaceConstExpr(manSticky32);
+  manSticky32 = roundMantissa(manSticky32);
+  exponent -= bit;
+
+  manSticky32 = manSticky32 << 3;
+  bit = normalize32BitMantissaInPlaceConstExpr(manSticky32);
+  manSticky32 = roundMantissa(manSticky32);
+  exponent -= bit;
+
+  uint32_t sign = (swFloatSignBits(a) ^ swFloatSignBits(b)) ? 1 : 0;
+  return swFloatPackBits(sign, exponent, manSticky32);
+}
+
+constexpr uint32_t swFloatDivisionBitsConstExpr(uint32_t a, uint32_t b) {
+  uint32_t amantissa = insertHiddenOneConstExpr(a);
+  uint32_t bmantissa = insertHiddenOneConstExpr(b);
+
+  int aexp = int(swFloatExponentBits(a)) - 127;
+  int bexp = int(swFloatExponentBits(b)) - 127;
+  int exponent = (aexp - bexp) + 127;
+
+  uint32_t bmantbit = countMantissaBitsConstExpr(bmantissa) + 1;
+
+  uint32_t mask = ((1u << 24) - 1);
+  uint32_t divmant = (bmantissa & mask) >> (24u - bmantbit);
+
+  uint64_t result = 0;
+  uint32_t start = (amantissa >> (24u - bmantbit));
+
+  int startingIndex = 24 - bmantbit - 1;
+  for (int i = 0; i < (50); ++i, --startingIndex) {
+
+    uint32_t currHigh = findHighestBitConstExpr(start) + 1;
+    result = result << 1;
+    if ((currHigh >= bmantbit) & (divmant <= start)) {
+      result |= 1;
+      start -= divmant;
+    }
+
+    // same as the runtime version, without evaluating the out of range shift
+    uint32_t newExtracted =
+        startingIndex >= 0 ? (amantissa >> startingIndex) & 1 : 0;
+    start = (start << 1) | newExtracted;
+  }
+
+  uint32_t extra = result & ((1u << 24) - 1);
+  result = result >> 23;
+
+  uint32_t result32 = static_cast<uint32_t>(result);
+  result32 = extra ? result32 | 1 : result32;
+
+  int bit = normalize32BitMantissaInPlaceConstExpr(result32);
+  exponent -= bit;
+  result32 = roundMantissa(result32);
+
+  uint32_t sign = (swFloatSignBits(a) ^ swFloatSignBits(b)) ? 1 : 0;
+  return swFloatPackBits(sign, exponent, result32);
+}
+
+#ifdef __cpp_lib_bit_cast
+// float front end of the constexpr soft float, needs std::bit_cast (c++20)
+constexpr float swFloatAdditionConstExpr(float a, float b) {
+  return std::bit_cast<float>(swFloatAdditionBitsConstExpr(
+      std::bit_cast<uint32_t>(a), std::bit_cast<uint32_t>(b)));
+}
+
+constexpr float swFloatMultiplicationConstExpr(float a, float b) {
+  return std::bit_cast<float>(swFloatMultiplicationBitsConstExpr(
+      std::bit_cast<uint32_t>(a), std::bit_cast<uint32_t>(b)));
+}
+
+constexpr float swFloatDivisionConstExpr(float a, float b) {
+  return std::bit_cast<float>(swFloatDivisionBitsConstExpr(
+      std::bit_cast<uint32_t>(a), std::bit_cast<uint32_t>(b)));
+}
+
+// helper to bake a table at compile time, the generator gets called with the
+// index of the entry, for example a reciprocal seed table:
+// constexpr auto seeds = generateSWFloatTable<256>([](size_t i) {
+//   return swFloatDivisionConstExpr(1.0f, 1.0f + float(i) / 256.0f);
+// });
+template <size_t N, typename Generator>
+constexpr std::array<float, N> generateSWFloatTable(Generator generator) {
+  std::array<float, N> table{};
+  for (size_t i = 0; i < N; ++i) {
+    table[i] = generator(i);
+  }
+  return table;
+}
+#endif
+
+KERNEL_ISA_NAMESPACE_END
@@ -0,0 +1,64 @@
+// compiled once per instruction set, see isaDispatch.h
+
+#include "softFloatBatch.h"
+#include "../dispatch/isaDispatch.h"
+#include "floatingPointSoftware.h"
+#include "swFloat8.h"
+
+template <SWFloat (*OPERATION)(SWFloat, SWFloat)>
+static void applyBatch(const float *a, const float *b, float *out,
+                       size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    SWFloat fa;
+    SWFloat fb;
+    fa.original = a[i];
+    fb.original = b[i];
+    out[i] = OPERATION(fa, fb).original;
+  }
+}
+
+#if defined(__AVX2__)
+// 8 at the time through the lane wise kernels, same bits as the scalar ones,
+// the tail goes through the scalar version
+template <__m256i (*OPERATION8)(__m256i, __m256i),
+          SWFloat (*OPERATION)(SWFloat, SWFloat)>
+static void applyBatch8(const float *a, const float *b, float *out,
+                        size_t count) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256i fa = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+    __m256i fb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i),
+                        OPERATION8(fa, fb));
+  }
+  applyBatch<OPERATION>(a + i, b + i, out + i, count - i);
+}
+#endif
+
+void KERNEL_ISA_NAME(swFloatAdditionBatch)(const float *a, const float *b,
+                                           float *out, size_t count) {
+#if defined(__AVX2__)
+  applyBatch8<swFloatAddition8, swFloatAddition>(a, b, out, count);
+#else
+  applyBatch<swFloatAddition>(a, b, out, count);
+#endif
+}
+
+void KERNEL_ISA_NAME(swFloatMultiplicationBatch)(const float *a,
+                                                 const float *b, float *out,
+                                                 size_t count) {
+#if defined(__AVX2__)
+  applyBatch8<swFloatMultiplication8, swFloatMultiplication>(a, b, out, count);
+#else
+  applyBatch<swFloatMultiplication>(a, b, out, count);
+#endif
+}
+
+void KERNEL_ISA_NAME(swFloatDivisionBatch)(const float *a, const float *b,
+                                           float *out, size_t count) {
+#if defined(__AVX2__)
+  applyBatch8<swFloatDivision8, swFloatDivision>(a, b, out, count);
+#else
+  applyBatch<swFloatDivision>(a, b, out, count);
+#endif
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+// batched soft float operations, out[i] = a[i] op b[i], bit identical to the
+// swFloat* functions, the implementation is picked at runtime based on the
+// cpu, the avx builds get the lzcnt based bit scan
+void swFloatAdditionBatch(const float *a, const float *b, float *out,
+                          size_t count);
+void swFloatMultiplicationBatch(const float *a, const float *b, float *out,
+                                size_t count);
+void swFloatDivisionBatch(const float *a, const float *b, float *out,
+                          size_t count);
+
+#define SOFT_FLOAT_BATCH_DECLARE(SUFFIX)                                       \
+  void swFloatAdditionBatch##SUFFIX(const float *a, const float *b,            \
+                                    float *out, size_t count);                 \
+  void swFloatMultiplicationBatch##SUFFIX(const float *a, const float *b,      \
+                                          float *out, size_t count);           \
+  void swFloatDivisionBatch##SUFFIX(const float *a, const float *b,            \
+                                    float *out, size_t count);
+
+// single instruction set versions
+SOFT_FLOAT_BATCH_DECLARE(Scalar)
+SOFT_FLOAT_BATCH_DECLARE(Avx2)
+SOFT_FLOAT_BATCH_DECLARE(Avx512)
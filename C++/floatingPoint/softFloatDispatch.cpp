@@ -0,0 +1,30 @@
+#include "../dispatch/isaDispatch.h"
+#include "../instrumentation/instrumentation.h"
+#include "softFloatBatch.h"
+
+void swFloatAdditionBatch(const float *a, const float *b, float *out,
+                          size_t count) {
+  static const auto kernel = dispatch::selectKernel(
+      swFloatAdditionBatchScalar, swFloatAdditionBatchAvx2,
+      swFloatAdditionBatchAvx512);
+  KERNELS_TRACE_SCOPE("swFloatAdditionBatch");
+  kernel(a, b, out, count);
+}
+
+void swFloatMultiplicationBatch(const float *a, const float *b, float *out,
+                                size_t count) {
+  static const auto kernel = dispatch::selectKernel(
+      swFloatMultiplicationBatchScalar, swFloatMultiplicationBatchAvx2,
+      swFloatMultiplicationBatchAvx512);
+  KERNELS_TRACE_SCOPE("swFloatMultiplicationBatch");
+  kernel(a, b, out, count);
+}
+
+void swFloatDivisionBatch(const float *a, const float *b, float *out,
+                          size_t count) {
+  static const auto kernel = dispatch::selectKernel(
+      swFloatDivisionBatchScalar, swFloatDivisionBatchAvx2,
+      swFloatDivisionBatchAvx512);
+  KERNELS_TRACE_SCOPE("swFloatDivisionBatch");
+  kernel(a, b, out, count);
+}
@@ -0,0 +1,362 @@
+#pragma once
+
+#include "floatingPointSoftware.h"
+
+#include <immintrin.h>
+
+// 8 wide soft float, every function follows step by step its scalar version
+// in floatingPointSoftware.h on the raw bits of 8 floats, so the results are
+// bit identical to swFloatAddition, swFloatMultiplication and
+// swFloatDivision for any input, not only the normal range. The data
+// dependent loops of the scalar code (shiftExponent, the division) become
+// closed forms or fixed trip counts, nothing branches on the values.
+// Needs AVX2, when building for a plain x86-64 target only the scalar
+// version is available
+
+#if defined(__AVX2__)
+
+KERNEL_ISA_NAMESPACE_BEGIN
+
+// highest set bit per lane, same results as findHighestBit, 0xFFFFFFFF for
+// zero. Goes through the float conversion, v & ~(v >> 1) clears the bit
+// below the top one so the rounding can't carry into the next power of two
+inline __m256i findHighestBit8(__m256i v) {
+  __m256i top = _mm256_andnot_si256(_mm256_srli_epi32(v, 1), v);
+  __m256i exponent =
+      _mm256_srli_epi32(_mm256_castps_si256(_mm256_cvtepi32_ps(top)), 23);
+  __m256i bit = _mm256_sub_epi32(exponent, _mm256_set1_epi32(127));
+  // the conversion is signed, the top bit lanes get fixed up here
+  __m256i isZero = _mm256_cmpeq_epi32(v, _mm256_setzero_si256());
+  __m256i isTop = _mm256_srai_epi32(v, 31);
+  bit = _mm256_blendv_epi8(bit, _mm256_set1_epi32(31), isTop);
+  return _mm256_or_si256(bit, isZero);
+}
+
+// shiftExponent without the loop: every step moves the bit that falls off
+// into the sticky bit, in the end that is "any of the bits 1 to count was
+// set", bit 0 is shifted out before it is ever looked at. Counts of 32 and
+// more shift everything out, which is what srlv does
+inline __m256i shiftExponent8(__m256i mantissa, __m256i count) {
+  const __m256i one = _mm256_set1_epi32(1);
+  __m256i lost = _mm256_and_si256(
+      _mm256_srli_epi32(mantissa, 1),
+      _mm256_sub_epi32(_mm256_sllv_epi32(one, count), one));
+  __m256i sticky = _mm256_andnot_si256(
+      _mm256_cmpeq_epi32(lost, _mm256_setzero_si256()), one);
+  return _mm256_or_si256(_mm256_srlv_epi32(mantissa, count), sticky);
+}
+
+inline __m256i normalize32BitMantissaInPlace8(__m256i &mantissa) {
+  const __m256i sticky = _mm256_and_si256(mantissa, _mm256_set1_epi32(1));
+  __m256i bit =
+      _mm256_sub_epi32(_mm256_set1_epi32(26), findHighestBit8(mantissa));
+
+  __m256i outOfRange = _mm256_cmpgt_epi32(bit, _mm256_set1_epi32(23));
+  __m256i value = _mm256_andnot_si256(outOfRange, mantissa);
+  __m256i returnValue =
+      _mm256_blendv_epi8(bit, _mm256_set1_epi32(DENORMAL), outOfRange);
+
+  __m256i left = _mm256_sllv_epi32(
+      value, _mm256_and_si256(bit, _mm256_set1_epi32(31)));
+  __m256i right = _mm256_srlv_epi32(value, _mm256_abs_epi32(bit));
+  __m256i useLeft =
+      _mm256_and_si256(_mm256_cmpgt_epi32(bit, _mm256_setzero_si256()),
+                       _mm256_cmpgt_epi32(_mm256_set1_epi32(23), bit));
+  mantissa = _mm256_or_si256(_mm256_blendv_epi8(right, left, useLeft), sticky);
+  return returnValue;
+}
+
+inline __m256i roundMantissa8(__m256i mantissa) {
+  const __m256i four = _mm256_set1_epi32(4);
+  __m256i grs = _mm256_and_si256(mantissa, _mm256_set1_epi32(7));
+  __m256i cleaned = _mm256_srli_epi32(mantissa, 3);
+  __m256i odd = _mm256_slli_epi32(cleaned, 31);
+  // above half rounds up, exactly half rounds to even
+  __m256i up = _mm256_or_si256(
+      _mm256_cmpgt_epi32(grs, four),
+      _mm256_and_si256(_mm256_cmpeq_epi32(grs, four), _mm256_srai_epi32(odd, 31)));
+  return _mm256_sub_epi32(cleaned, up);
+}
+
+// lanes where the rounding had something to round, for the counters
+inline int swFloatInexactLanes8(__m256i mantissa) {
+  __m256i exact = _mm256_cmpeq_epi32(
+      _mm256_and_si256(mantissa, _mm256_set1_epi32(7)), _mm256_setzero_si256());
+  return 8 - __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(exact)));
+}
+
+inline int swFloatDenormalLanes8(__m256i bit) {
+  __m256i denormal = _mm256_cmpeq_epi32(bit, _mm256_set1_epi32(DENORMAL));
+  return __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(denormal)));
+}
+
+// same packing as assigning the SWFloat bitfields, values get truncated to
+// the size of the field
+inline __m256i swFloatPackBits8(__m256i sign, __m256i exponent,
+                                __m256i mantissa) {
+  __m256i packed = _mm256_slli_epi32(sign, 31);
+  packed = _mm256_or_si256(
+      packed, _mm256_slli_epi32(
+                  _mm256_and_si256(exponent, _mm256_set1_epi32(0xFF)), 23));
+  return _mm256_or_si256(
+      packed, _mm256_and_si256(mantissa, _mm256_set1_epi32(0x7FFFFF)));
+}
+
+inline __m256i swFloatExponent8(__m256i value) {
+  return _mm256_and_si256(_mm256_srli_epi32(value, 23),
+                          _mm256_set1_epi32(0xFF));
+}
+
+inline __m256i insertHiddenOne8(__m256i value) {
+  return _mm256_or_si256(_mm256_and_si256(value, _mm256_set1_epi32(0x7FFFFF)),
+                         _mm256_set1_epi32(1 << 23));
+}
+
+inline __m256i swFloatAddition8(__m256i a, __m256i b) {
+  KERNELS_COUNT_N(SoftFloatCalls, 8);
+  __m256i aExponent = swFloatExponent8(a);
+  __m256i bExponent = swFloatExponent8(b);
+  __m256i aSign = _mm256_srli_epi32(a, 31);
+  __m256i bSign = _mm256_srli_epi32(b, 31);
+
+  // the lower exponent gets raised to the other one, shifting its mantissa
+  __m256i delta = _mm256_sub_epi32(aExponent, bExponent);
+  __m256i shift = _mm256_abs_epi32(delta);
+  __m256i aLower = _mm256_cmpgt_epi32(_mm256_setzero_si256(), delta);
+  __m256i amantissa = _mm256_slli_epi32(insertHiddenOne8(a), 3);
+  __m256i bmantissa = _mm256_slli_epi32(insertHiddenOne8(b), 3);
+  amantissa = _mm256_blendv_epi8(amantissa, shiftExponent8(amantissa, shift),
+                                 aLower);
+  bmantissa = _mm256_blendv_epi8(shiftExponent8(bmantissa, shift), bmantissa,
+                                 aLower);
+  __m256i exponent = _mm256_max_epi32(aExponent, bExponent);
+
+  // the scalar code has two paths, they only differ in the mantissa they
+  // normalize and in the sign, the denormal check can't trigger when adding
+  // two numbers of the same sign so one normalization does for both
+  __m256i sameSign = _mm256_cmpeq_epi32(aSign, bSign);
+  __m256i added = _mm256_add_epi32(amantissa, bmantissa);
+  __m256i difference = _mm256_blendv_epi8(
+      _mm256_sub_epi32(amantissa, bmantissa),
+      _mm256_sub_epi32(bmantissa, amantissa), _mm256_srai_epi32(a, 31));
+  __m256i flipped = _mm256_srli_epi32(difference, 31);
+  __m256i mantissa =
+      _mm256_blendv_epi8(_mm256_abs_epi32(difference), added, sameSign);
+
+  __m256i bit = normalize32BitMantissaInPlace8(mantissa);
+  KERNELS_COUNT_N(SoftFloatDenormals, swFloatDenormalLanes8(bit));
+  KERNELS_COUNT_N(SoftFloatRounding, swFloatInexactLanes8(mantissa));
+  mantissa = roundMantissa8(mantissa);
+
+  __m256i denormal = _mm256_cmpeq_epi32(bit, _mm256_set1_epi32(DENORMAL));
+  exponent = _mm256_add_epi32(_mm256_sub_epi32(exponent, bit),
+                              _mm256_srli_epi32(mantissa, 24));
+  exponent = _mm256_andnot_si256(denormal, exponent);
+  __m256i sign = _mm256_blendv_epi8(_mm256_andnot_si256(denormal, flipped),
+                                    aSign, sameSign);
+  return swFloatPackBits8(sign, exponent, mantissa);
+}
+
+inline __m256i swFloatMultiplication8(__m256i a, __m256i b) {
+  KERNELS_COUNT_N(SoftFloatCalls, 8);
+  __m256i amantissa = insertHiddenOne8(a);
+  __m256i bmantissa = insertHiddenOne8(b);
+  __m256i exponent =
+      _mm256_sub_epi32(_mm256_add_epi32(swFloatExponent8(a), swFloatExponent8(b)),
+                       _mm256_set1_epi32(127));
+
+  // the 48 bits product, even and odd lanes separately. The scalar code
+  // appends the grs bits and shifts by 23 with sticky, that is the product
+  // shifted by 20 with the sticky set if any of its lower 21 bits is
+  __m256i even = _mm256_mul_epu32(amantissa, bmantissa);
+  __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(amantissa, 32),
+                                 _mm256_srli_epi64(bmantissa, 32));
+  __m256i shifted = _mm256_blend_epi32(
+      _mm256_srli_epi64(even, 20),
+      _mm256_slli_epi64(_mm256_srli_epi64(odd, 20), 32), 0xAA);
+  const __m256i lowMask = _mm256_set1_epi64x((1 << 21) - 1);
+  __m256i low = _mm256_blend_epi32(
+      _mm256_and_si256(even, lowMask),
+      _mm256_slli_epi64(_mm256_and_si256(odd, lowMask), 32), 0xAA);
+  __m256i sticky = _mm256_andnot_si256(
+      _mm256_cmpeq_epi32(low, _mm256_setzero_si256()), _mm256_set1_epi32(1));
+  __m256i mantissa = _mm256_or_si256(shifted, sticky);
+
+  __m256i bit = normalize32BitMantissaInPlace8(mantissa);
+  KERNELS_COUNT_N(SoftFloatDenormals, swFloatDenormalLanes8(bit));
+  KERNELS_COUNT_N(SoftFloatRounding, swFloatInexactLanes8(mantissa));
+  mantissa = roundMantissa8(mantissa);
+  exponent = _mm256_sub_epi32(exponent, bit);
+
+  // the rounding can denormalize it again, same as the scalar code
+  mantissa = _mm256_slli_epi32(mantissa, 3);
+  bit = normalize32BitMantissaInPlace8(mantissa);
+  mantissa = roundMantissa8(mantissa);
+  exponent = _mm256_sub_epi32(exponent, bit);
+
+  __m256i sign = _mm256_srli_epi32(_mm256_xor_si256(a, b), 31);
+  return swFloatPackBits8(sign, exponent, mantissa);
+}
+
+inline __m256i swFloatDivision8(__m256i a, __m256i b) {
+  KERNELS_COUNT_N(SoftFloatCalls, 8);
+  const __m256i one = _mm256_set1_epi32(1);
+  __m256i amantissa = insertHiddenOne8(a);
+  __m256i bmantissa = insertHiddenOne8(b);
+  __m256i exponent =
+      _mm256_add_epi32(_mm256_sub_epi32(swFloatExponent8(a), swFloatExponent8(b)),
+                       _mm256_set1_epi32(127));
+
+  // the scalar code strips the trailing zeros of the divisor, the lowest set
+  // bit is a power of two the float conversion gives the position of exactly
+  __m256i lowest = _mm256_and_si256(
+      bmantissa, _mm256_sub_epi32(_mm256_setzero_si256(), bmantissa));
+  __m256i trailing = _mm256_sub_epi32(
+      _mm256_srli_epi32(_mm256_castps_si256(_mm256_cvtepi32_ps(lowest)), 23),
+      _mm256_set1_epi32(127));
+  __m256i divisor = _mm256_srlv_epi32(bmantissa, trailing);
+  __m256i remainder = _mm256_srlv_epi32(amantissa, trailing);
+  // index of the next dividend bit to bring down, once negative the shift
+  // count is huge as unsigned and srlv brings down zeros
+  __m256i index = _mm256_sub_epi32(trailing, one);
+
+  // long division, 50 quotient bits. The first 27 are the result, the
+  // sticky is any set bit from the 27th on (the scalar code overlaps them)
+  __m256i quotient = _mm256_setzero_si256();
+  __m256i sticky = _mm256_setzero_si256();
+  for (int i = 0; i < 50; ++i) {
+    // remainder >= divisor, the scalar check on the bit count is implied
+    __m256i fits =
+        _mm256_cmpeq_epi32(_mm256_max_epu32(remainder, divisor), remainder);
+    __m256i quotientBit = _mm256_and_si256(fits, one);
+    remainder = _mm256_sub_epi32(remainder, _mm256_and_si256(fits, divisor));
+    if (i <= 26) {
+      quotient = _mm256_or_si256(_mm256_slli_epi32(quotient, 1), quotientBit);
+    }
+    if (i >= 26) {
+      sticky = _mm256_or_si256(sticky, quotientBit);
+    }
+    __m256i extracted =
+        _mm256_and_si256(_mm256_srlv_epi32(amantissa, index), one);
+    remainder = _mm256_or_si256(_mm256_slli_epi32(remainder, 1), extracted);
+    index = _mm256_sub_epi32(index, one);
+  }
+  __m256i mantissa = _mm256_or_si256(quotient, sticky);
+
+  __m256i bit = normalize32BitMantissaInPlace8(mantissa);
+  exponent = _mm256_sub_epi32(exponent, bit);
+  KERNELS_COUNT_N(SoftFloatDenormals, swFloatDenormalLanes8(bit));
+  KERNELS_COUNT_N(SoftFloatRounding, swFloatInexactLanes8(mantissa));
+  mantissa = roundMantissa8(mantissa);
+
+  __m256i sign = _mm256_srli_epi32(_mm256_xor_si256(a, b), 31);
+  return swFloatPackBits8(sign, exponent, mantissa);
+}
+
+// 8 floats going through the soft float, the operators mirror the ones of
+// SWFloat, so a template written for SWFloat (or float) runs 8 wide with
+// the same results lane by lane. Comparisons are the exception, they give a
+// SWFloat8Mask instead of a bool, code that branches on them has to go
+// through select, min, max or anyLane and allLanes to work with both
+struct SWFloat8 {
+  __m256i bits;
+
+  SWFloat8() = default;
+  // broadcast, lets constants in templated code work as they are
+  SWFloat8(float value)
+      : bits(_mm256_castps_si256(_mm256_set1_ps(value))) {}
+  explicit SWFloat8(SWFloat value) : SWFloat8(value.original) {}
+  explicit SWFloat8(__m256 values) : bits(_mm256_castps_si256(values)) {}
+  explicit SWFloat8(__m256i rawBits) : bits(rawBits) {}
+
+  static SWFloat8 load(const float *values) {
+    return SWFloat8(_mm256_loadu_ps(values));
+  }
+  void store(float *values) const {
+    _mm256_storeu_ps(values, _mm256_castsi256_ps(bits));
+  }
+  __m256 floats() const { return _mm256_castsi256_ps(bits); }
+  SWFloat lane(int index) const {
+    alignas(32) float values[8];
+    _mm256_store_ps(values, floats());
+    return SWFloat(values[index]);
+  }
+};
+
+inline SWFloat8 operator-(SWFloat8 a) {
+  return SWFloat8(_mm256_xor_si256(a.bits, _mm256_set1_epi32(INT32_MIN)));
+}
+inline SWFloat8 operator+(SWFloat8 a, SWFloat8 b) {
+  return SWFloat8(swFloatAddition8(a.bits, b.bits));
+}
+inline SWFloat8 operator-(SWFloat8 a, SWFloat8 b) { return a + (-b); }
+inline SWFloat8 operator*(SWFloat8 a, SWFloat8 b) {
+  return SWFloat8(swFloatMultiplication8(a.bits, b.bits));
+}
+inline SWFloat8 operator/(SWFloat8 a, SWFloat8 b) {
+  return SWFloat8(swFloatDivision8(a.bits, b.bits));
+}
+inline SWFloat8 &operator+=(SWFloat8 &a, SWFloat8 b) { return a = a + b; }
+inline SWFloat8 &operator-=(SWFloat8 &a, SWFloat8 b) { return a = a - b; }
+inline SWFloat8 &operator*=(SWFloat8 &a, SWFloat8 b) { return a = a * b; }
+inline SWFloat8 &operator/=(SWFloat8 &a, SWFloat8 b) { return a = a / b; }
+
+inline SWFloat8 abs(SWFloat8 a) {
+  return SWFloat8(_mm256_and_si256(a.bits, _mm256_set1_epi32(INT32_MAX)));
+}
+
+// what the comparisons give, all ones in the lanes where they hold. They
+// compare in hardware like the SWFloat ones, ordered so a nan lane is false
+// except for !=
+struct SWFloat8Mask {
+  __m256 lanes;
+
+  explicit SWFloat8Mask(__m256 values) : lanes(values) {}
+  // bit i for lane i
+  int bits() const { return _mm256_movemask_ps(lanes); }
+};
+
+inline SWFloat8Mask operator&(SWFloat8Mask a, SWFloat8Mask b) {
+  return SWFloat8Mask(_mm256_and_ps(a.lanes, b.lanes));
+}
+inline SWFloat8Mask operator|(SWFloat8Mask a, SWFloat8Mask b) {
+  return SWFloat8Mask(_mm256_or_ps(a.lanes, b.lanes));
+}
+inline SWFloat8Mask operator!(SWFloat8Mask a) {
+  return SWFloat8Mask(_mm256_xor_ps(
+      a.lanes, _mm256_castsi256_ps(_mm256_set1_epi32(-1))));
+}
+inline bool anyLane(SWFloat8Mask a) { return a.bits() != 0; }
+inline bool allLanes(SWFloat8Mask a) { return a.bits() == 0xFF; }
+
+inline SWFloat8Mask operator==(SWFloat8 a, SWFloat8 b) {
+  return SWFloat8Mask(_mm256_cmp_ps(a.floats(), b.floats(), _CMP_EQ_OQ));
+}
+inline SWFloat8Mask operator!=(SWFloat8 a, SWFloat8 b) {
+  return SWFloat8Mask(_mm256_cmp_ps(a.floats(), b.floats(), _CMP_NEQ_UQ));
+}
+inline SWFloat8Mask operator<(SWFloat8 a, SWFloat8 b) {
+  return SWFloat8Mask(_mm256_cmp_ps(a.floats(), b.floats(), _CMP_LT_OQ));
+}
+inline SWFloat8Mask operator>(SWFloat8 a, SWFloat8 b) {
+  return SWFloat8Mask(_mm256_cmp_ps(a.floats(), b.floats(), _CMP_GT_OQ));
+}
+inline SWFloat8Mask operator<=(SWFloat8 a, SWFloat8 b) {
+  return SWFloat8Mask(_mm256_cmp_ps(a.floats(), b.floats(), _CMP_LE_OQ));
+}
+inline SWFloat8Mask operator>=(SWFloat8 a, SWFloat8 b) {
+  return SWFloat8Mask(_mm256_cmp_ps(a.floats(), b.floats(), _CMP_GE_OQ));
+}
+
+// a in the lanes of the mask, b in the others, a blend rather than a branch
+inline SWFloat8 select(SWFloat8Mask condition, SWFloat8 a, SWFloat8 b) {
+  return SWFloat8(_mm256_blendv_ps(b.floats(), a.floats(), condition.lanes));
+}
+// not minps and maxps, they answer differently from std::min and std::max
+// for nans and signed zeros
+inline SWFloat8 min(SWFloat8 a, SWFloat8 b) { return select(b < a, b, a); }
+inline SWFloat8 max(SWFloat8 a, SWFloat8 b) { return select(a < b, b, a); }
+
+KERNEL_ISA_NAMESPACE_END
+
+#endif
@@ -0,0 +1,91 @@
+// built with the Avx2 flags, nothing in here runs unless the test checked the
+// cpu first, see avx2Test.h
+
+#include "avx2Kernels.h"
+
+#include "../branchless/uv.h"
+#include "../floatingPoint/swFloat8.h"
+
+namespace avx2_kernels {
+
+void offsetUVsNoBranch1(const float uv[2], float offset_uv[2]) {
+  ::offsetUVsNoBranch1(uv, offset_uv);
+}
+
+void offsetUVsNoBranch2(const float uv[2], float offset_uv[2]) {
+  ::offsetUVsNoBranch2(uv, offset_uv);
+}
+
+void offsetUVsNoBranch1(const float uv[2], float offset_uv[2], float offset) {
+  ::offsetUVsNoBranch1(uv, offset_uv, UVOffsets<float>(offset));
+}
+
+void offsetUVsNoBranch2(const float uv[2], float offset_uv[2], float offset) {
+  ::offsetUVsNoBranch2(uv, offset_uv, UVOffsets<float>(offset));
+}
+
+void compress256(const float values[8], unsigned int mask, float out[8]) {
+  _mm256_storeu_ps(out, ::compress256(_mm256_loadu_ps(values), mask));
+}
+
+template <__m256i (*OPERATION)(__m256i, __m256i)>
+static void packed(const uint32_t lhs[8], const uint32_t rhs[8],
+                   uint32_t out[8]) {
+  _mm256_storeu_si256(
+      reinterpret_cast<__m256i *>(out),
+      OPERATION(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs)),
+                _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs))));
+}
+
+void swFloatAddition8(const uint32_t lhs[8], const uint32_t rhs[8],
+                      uint32_t out[8]) {
+  packed<::swFloatAddition8>(lhs, rhs, out);
+}
+
+void swFloatMultiplication8(const uint32_t lhs[8], const uint32_t rhs[8],
+                            uint32_t out[8]) {
+  packed<::swFloatMultiplication8>(lhs, rhs, out);
+}
+
+void swFloatDivision8(const uint32_t lhs[8], const uint32_t rhs[8],
+                      uint32_t out[8]) {
+  packed<::swFloatDivision8>(lhs, rhs, out);
+}
+
+void newtonSqrt8(const float values[8], int iterations, float out[8]) {
+  newtonSqrt(SWFloat8::load(values), iterations).store(out);
+}
+
+void clampedSqrt8(const float values[8], float lo, float hi, float out[8],
+                  int &steps) {
+  clampedSqrt(SWFloat8::load(values), SWFloat8(lo), SWFloat8(hi), steps)
+      .store(out);
+}
+
+void valueTypeOperations8(const float values[8], float out[8]) {
+  SWFloat8 v = SWFloat8::load(values);
+  SWFloat8 w = -abs(v) + 1.0f;
+  w -= v;
+  w *= 2.0f;
+  w /= SWFloat8(4.0f);
+  w.store(out);
+}
+
+void compare8(const uint32_t lhs[8], const uint32_t rhs[8], int masks[6],
+              uint32_t picked[3][8]) {
+  SWFloat8 x(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs)));
+  SWFloat8 y(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs)));
+  masks[0] = (x == y).bits();
+  masks[1] = (x != y).bits();
+  masks[2] = (x < y).bits();
+  masks[3] = (x > y).bits();
+  masks[4] = (x <= y).bits();
+  masks[5] = (x >= y).bits();
+  const SWFloat8 results[3] = {min(x, y), max(x, y), select(x < y, y, x)};
+  for (int r = 0; r < 3; ++r) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(picked[r]),
+                        results[r].bits);
+  }
+}
+
+} // namespace avx2_kernels
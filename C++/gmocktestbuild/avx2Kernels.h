@@ -0,0 +1,63 @@
+#pragma once
+
+#include "../floatingPoint/floatingPointSoftware.h"
+
+#include <cstdint>
+
+// The single call avx2 kernels of uv.h and swFloat8.h, wrapped in plain
+// functions of avx2Kernels.cpp. That file is the only one of the suite built
+// with the avx2 flags, the tests themselves are baseline code that checks the
+// cpu before calling anything in here, see avx2Test.h
+namespace avx2_kernels {
+
+void offsetUVsNoBranch1(const float uv[2], float offset_uv[2]);
+void offsetUVsNoBranch2(const float uv[2], float offset_uv[2]);
+void offsetUVsNoBranch1(const float uv[2], float offset_uv[2], float offset);
+void offsetUVsNoBranch2(const float uv[2], float offset_uv[2], float offset);
+void compress256(const float values[8], unsigned int mask, float out[8]);
+
+// 8 lanes of float bits in and out
+void swFloatAddition8(const uint32_t lhs[8], const uint32_t rhs[8],
+                      uint32_t out[8]);
+void swFloatMultiplication8(const uint32_t lhs[8], const uint32_t rhs[8],
+                            uint32_t out[8]);
+void swFloatDivision8(const uint32_t lhs[8], const uint32_t rhs[8],
+                      uint32_t out[8]);
+
+// the SWFloat8 halves of the swFloat8Test checks, the scalar halves run the
+// same templates with SWFloat
+void newtonSqrt8(const float values[8], int iterations, float out[8]);
+void clampedSqrt8(const float values[8], float lo, float hi, float out[8],
+                  int &steps);
+// ((-|v| + 1) - v) * 2 / 4 with the operators of the value type
+void valueTypeOperations8(const float values[8], float out[8]);
+// masks of ==, !=, <, >, <=, >= and the bits of min, max and select(x < y)
+void compare8(const uint32_t lhs[8], const uint32_t rhs[8], int masks[6],
+              uint32_t picked[3][8]);
+
+} // namespace avx2_kernels
+
+// written once for float like types, runs with float, SWFloat and SWFloat8
+template <typename T> T newtonSqrt(T value, int iterations) {
+  T x = value;
+  for (int i = 0; i < iterations; ++i) {
+    x = (x + value / x) * 0.5f;
+  }
+  return x;
+}
+
+// clamps to [lo, hi] then runs newton from above until every lane stops
+// moving, the min keeps a lane that reached its fixed point there so the
+// lanes don't depend on how long the others take
+template <typename T> T clampedSqrt(T value, T lo, T hi, int &steps) {
+  T clamped = min(max(value, lo), hi);
+  T x = max(clamped, T(1.0f));
+  for (steps = 0; steps < 100; ++steps) {
+    T next = min((x + clamped / x) * 0.5f, x);
+    if (allLanes(next == x)) {
+      break;
+    }
+    x = next;
+  }
+  return x;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "avx2Kernels.h"
+
+#include "../dispatch/isaDispatch.h"
+
+#include <gmock/gmock.h>
+
+// skips on cpus without avx2, before the test body gets to call the kernels
+class Avx2Test : public ::testing::Test {
+protected:
+  void SetUp() override {
+    if (!dispatch::isaSupported(dispatch::Isa::Avx2)) {
+      GTEST_SKIP() << "cpu does not support avx2";
+    }
+  }
+};
@@ -0,0 +1,148 @@
+#include "../branchless/uv.h"
+#include "../branchless/uvBatch.h"
+#include "../dispatch/isaDispatch.h"
+#include "../floatingPoint/floatingPointSoftware.h"
+#include "../floatingPoint/softFloatBatch.h"
+
+#include <gmock/gmock.h>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+using dispatch::Isa;
+
+struct IsaKernels {
+  Isa isa;
+  void (*offsetUVs)(const float *, float *, size_t);
+  void (*offsetUVsFloat)(const float *, float *, size_t, float);
+  void (*offsetUVsDouble)(const double *, double *, size_t, double);
+  void (*addition)(const float *, const float *, float *, size_t);
+  void (*multiplication)(const float *, const float *, float *, size_t);
+  void (*division)(const float *, const float *, float *, size_t);
+};
+
+std::ostream &operator<<(std::ostream &os, const IsaKernels &k) {
+  return os << dispatch::isaName(k.isa);
+}
+
+class IsaVariant : public ::testing::TestWithParam<IsaKernels> {
+protected:
+  void SetUp() override {
+    if (!dispatch::isaSupported(GetParam().isa)) {
+      GTEST_SKIP() << "cpu does not support " << GetParam();
+    }
+  }
+};
+
+TEST_P(IsaVariant, uv_batch_matches_single_calls) {
+  // odd count so that the scalar tail gets exercised too
+  const size_t count = 1001;
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+  std::vector<float> uv(2 * count);
+  for (size_t i = 0; i < count; ++i) {
+    uv[2 * i] = distribution(rng);
+    uv[2 * i + 1] = distribution(rng) * (1.0f - uv[2 * i]);
+  }
+  // a few ties, all equal and on the edges
+  uv[0] = uv[1] = 1.0f / 3.0f;
+  uv[2] = 0.0f;
+  uv[3] = 0.0f;
+
+  std::vector<float> result(2 * count);
+  GetParam().offsetUVs(uv.data(), result.data(), count);
+  for (size_t i = 0; i < count; ++i) {
+    float expected[2];
+    offsetUVsNoBranch3(&uv[2 * i], expected);
+    ASSERT_EQ(result[2 * i], expected[0]) << "pair " << i;
+    ASSERT_EQ(result[2 * i + 1], expected[1]) << "pair " << i;
+  }
+}
+
+TEST_P(IsaVariant, uv_batch_with_offsets_matches_generic_kernel) {
+  const size_t count = 1003;
+  std::mt19937 rng(43);
+  std::uniform_real_distribution<double> distribution(0.0, 1.0);
+  std::vector<double> uvd(2 * count);
+  std::vector<float> uvf(2 * count);
+  for (size_t i = 0; i < count; ++i) {
+    uvd[2 * i] = distribution(rng);
+    uvd[2 * i + 1] = distribution(rng) * (1.0 - uvd[2 * i]);
+    uvf[2 * i] = float(uvd[2 * i]);
+    uvf[2 * i + 1] = float(uvd[2 * i + 1]);
+  }
+
+  const float offsetFloat = 1.0f / 4096.0f;
+  std::vector<float> resultFloat(2 * count);
+  GetParam().offsetUVsFloat(uvf.data(), resultFloat.data(), count,
+                            offsetFloat);
+  const double offsetDouble = 1.0 / 65536.0;
+  std::vector<double> resultDouble(2 * count);
+  GetParam().offsetUVsDouble(uvd.data(), resultDouble.data(), count,
+                             offsetDouble);
+  for (size_t i = 0; i < count; ++i) {
+    float expectedFloat[2];
+    offsetUVsNoBranch(&uvf[2 * i], expectedFloat,
+                      UVOffsets<float>(offsetFloat));
+    ASSERT_EQ(resultFloat[2 * i], expectedFloat[0]) << "pair " << i;
+    ASSERT_EQ(resultFloat[2 * i + 1], expectedFloat[1]) << "pair " << i;
+    double expectedDouble[2];
+    offsetUVsNoBranch(&uvd[2 * i], expectedDouble,
+                      UVOffsets<double>(offsetDouble));
+    ASSERT_EQ(resultDouble[2 * i], expectedDouble[0]) << "pair " << i;
+    ASSERT_EQ(resultDouble[2 * i + 1], expectedDouble[1]) << "pair " << i;
+  }
+}
+
+TEST_P(IsaVariant, soft_float_batch_matches_single_calls) {
+  const size_t count = 4096;
+  std::mt19937 rng(7);
+  std::vector<float> a(count), b(count), out(count);
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t abits = (rng() & 0x807FFFFFu) | ((65 + rng() % 125) << 23);
+    uint32_t bbits = (rng() & 0x807FFFFFu) | ((65 + rng() % 125) << 23);
+    std::memcpy(&a[i], &abits, sizeof(float));
+    std::memcpy(&b[i], &bbits, sizeof(float));
+  }
+
+  struct {
+    void (*batch)(const float *, const float *, float *, size_t);
+    SWFloat (*single)(SWFloat, SWFloat);
+  } operations[] = {{GetParam().addition, swFloatAddition},
+                    {GetParam().multiplication, swFloatMultiplication},
+                    {GetParam().division, swFloatDivision}};
+  for (const auto &operation : operations) {
+    operation.batch(a.data(), b.data(), out.data(), count);
+    for (size_t i = 0; i < count; ++i) {
+      SWFloat fa;
+      SWFloat fb;
+      fa.original = a[i];
+      fb.original = b[i];
+      ASSERT_EQ(out[i], operation.single(fa, fb).original) << "element " << i;
+    }
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Isas, IsaVariant,
+    ::testing::Values(
+        IsaKernels{Isa::Scalar, offsetUVsBatchScalar, offsetUVsBatchScalar,
+                   offsetUVsBatchScalar, swFloatAdditionBatchScalar,
+                   swFloatMultiplicationBatchScalar,
+                   swFloatDivisionBatchScalar},
+        IsaKernels{Isa::Avx2, offsetUVsBatchAvx2, offsetUVsBatchAvx2,
+                   offsetUVsBatchAvx2, swFloatAdditionBatchAvx2,
+                   swFloatMultiplicationBatchAvx2, swFloatDivisionBatchAvx2},
+        IsaKernels{Isa::Avx512, offsetUVsBatchAvx512, offsetUVsBatchAvx512,
+                   offsetUVsBatchAvx512, swFloatAdditionBatchAvx512,
+                   swFloatMultiplicationBatchAvx512,
+                   swFloatDivisionBatchAvx512}),
+    [](const ::testing::TestParamInfo<IsaKernels> &info) {
+      return std::string(dispatch::isaName(info.param.isa));
+    });
+
+TEST(dispatch, detected_isa_is_supported) {
+  EXPECT_TRUE(dispatch::isaSupported(dispatch::detectIsa()));
+  EXPECT_TRUE(dispatch::isaSupported(Isa::Scalar));
+}
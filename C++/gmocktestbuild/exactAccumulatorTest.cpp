@@ -0,0 +1,204 @@
+#include "propertyTesting.h"
+
+#include "../dispatch/isaDispatch.h"
+#include "../floatingPoint/exactAccumulator.h"
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+using property_testing::forAll;
+using property_testing::shrinkFloatBits;
+using property_testing::shrinkTuple;
+
+typedef std::tuple<uint32_t, uint32_t> FloatBits;
+
+static float fromBits(uint32_t bits) {
+  float value;
+  std::memcpy(&value, &bits, sizeof(bits));
+  return value;
+}
+
+static uint32_t toBits(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+// same bits, or both nan
+static bool sameFloat(float a, float b) {
+  return toBits(a) == toBits(b) || (std::isnan(a) && std::isnan(b));
+}
+
+static bool notNan(const FloatBits &o) {
+  return !std::isnan(fromBits(std::get<0>(o))) &&
+         !std::isnan(fromBits(std::get<1>(o)));
+}
+
+// the hardware rounds a single sum or product correctly, so with one or two
+// terms the accumulator has to give the exact same bits, over the full
+// range: denormals, overflow to inf, inf and nan
+TEST(ExactAccumulator, one_product_or_two_terms_match_hardware) {
+  auto generator = [](std::mt19937 &rng) { return FloatBits(rng(), rng()); };
+  auto shrink = [](const FloatBits &o) {
+    return shrinkTuple(o, shrinkFloatBits);
+  };
+  EXPECT_TRUE(forAll(generator, shrink, notNan, [](const FloatBits &o) {
+    float a = fromBits(std::get<0>(o));
+    float b = fromBits(std::get<1>(o));
+    float values[2] = {a, b};
+    return sameFloat(exactDot(&a, &b, 1), a * b) &&
+           sameFloat(exactSum(values, 2), a + b);
+  }));
+}
+
+// products of floats with exponents in a narrow range are integer multiples
+// of 2^-80 below 2^60, the exact sum fits in a 128 bits integer, and its
+// conversion to float rounds correctly
+TEST(ExactAccumulator, dot_matches_integer_reference) {
+  std::mt19937 rng(5);
+  for (int run = 0; run < 50; ++run) {
+    const size_t count = 1 + rng() % 3000;
+    std::vector<float> a(count), b(count);
+    __int128 reference = 0;
+    for (size_t i = 0; i < count; ++i) {
+      // mantissa * 2^(exponent - 150) with exponent in [110, 140]
+      uint32_t abits = (rng() & 0x807FFFFFu) | ((110 + rng() % 31) << 23);
+      uint32_t bbits = (rng() & 0x807FFFFFu) | ((110 + rng() % 31) << 23);
+      a[i] = fromBits(abits);
+      b[i] = fromBits(bbits);
+      __int128 product = __int128((abits & 0x7FFFFF) | (1 << 23)) *
+                         __int128((bbits & 0x7FFFFF) | (1 << 23));
+      int shift = int((abits >> 23) & 0xFF) + int((bbits >> 23) & 0xFF) - 300 + 80;
+      product <<= shift;
+      reference += ((abits ^ bbits) >> 31) ? -product : product;
+    }
+    float expected = std::ldexp(static_cast<float>(reference), -80);
+    ASSERT_EQ(toBits(exactDot(a.data(), b.data(), count)), toBits(expected))
+        << "run " << run;
+  }
+}
+
+TEST(ExactAccumulator, order_does_not_matter) {
+  std::mt19937 rng(9);
+  std::vector<float> values(10000);
+  for (float &value : values) {
+    // wide range of magnitudes, the hardware sum depends a lot on the order
+    uint32_t bits = (rng() & 0x807FFFFFu) | ((1 + rng() % 200) << 23);
+    value = fromBits(bits);
+  }
+  float sum = exactSum(values.data(), values.size());
+  for (int run = 0; run < 5; ++run) {
+    std::shuffle(values.begin(), values.end(), rng);
+    ASSERT_EQ(toBits(exactSum(values.data(), values.size())), toBits(sum));
+  }
+}
+
+TEST(ExactAccumulator, cancellation_and_range) {
+  float cancelling[4] = {1e30f, 3.0f, -1e30f, 1e-30f};
+  EXPECT_EQ(exactSum(cancelling, 4), 3.0f);
+
+  // the intermediate overflows in hardware, not in the accumulator
+  float overflowing[3] = {FLT_MAX, FLT_MAX, -FLT_MAX};
+  EXPECT_EQ(exactSum(overflowing, 3), FLT_MAX);
+  float twice[2] = {FLT_MAX, FLT_MAX};
+  EXPECT_EQ(exactSum(twice, 2), INFINITY);
+
+  // products below the smallest denormal still count
+  float tiny[2] = {1e-30f, 1e-30f};
+  float ones[2] = {1e-30f, -1e-30f};
+  EXPECT_EQ(toBits(exactDot(tiny, ones, 2)), 0u);
+  float small[3] = {FLT_MIN, 1e-30f, 1e-30f};
+  float scale[3] = {0.5f, 1e-30f, 1e-30f};
+  EXPECT_EQ(exactDot(small, scale, 3), FLT_MIN * 0.5f);
+
+  float exactZero[2] = {2.5f, -2.5f};
+  EXPECT_EQ(toBits(exactSum(exactZero, 2)), 0u);
+  EXPECT_EQ(toBits(exactSum(exactZero, 0)), 0u);
+}
+
+TEST(ExactAccumulator, inf_and_nan_follow_the_hardware) {
+  float infinite[3] = {1.0f, INFINITY, 2.0f};
+  EXPECT_EQ(exactSum(infinite, 3), INFINITY);
+  float both[2] = {INFINITY, -INFINITY};
+  EXPECT_TRUE(std::isnan(exactSum(both, 2)));
+  float zero[1] = {0.0f};
+  float inf[1] = {INFINITY};
+  EXPECT_TRUE(std::isnan(exactDot(zero, inf, 1)));
+  float nan[9] = {1, 2, 3, 4, 5, 6, 7, NAN, 9};
+  EXPECT_TRUE(std::isnan(exactSum(nan, 9)));
+}
+
+TEST(ExactAccumulator, merge_and_incremental_adds) {
+  std::mt19937 rng(3);
+  std::vector<float> a(1001), b(1001);
+  for (size_t i = 0; i < a.size(); ++i) {
+    a[i] = fromBits((rng() & 0x807FFFFFu) | ((60 + rng() % 130) << 23));
+    b[i] = fromBits((rng() & 0x807FFFFFu) | ((60 + rng() % 130) << 23));
+  }
+  float expected = exactDot(a.data(), b.data(), a.size());
+
+  ExactAccumulator first;
+  ExactAccumulator second;
+  first.addDot(a.data(), b.data(), 500);
+  for (size_t i = 500; i < a.size(); ++i) {
+    second.addProduct(a[i], b[i]);
+  }
+  first.merge(second);
+  EXPECT_EQ(toBits(first.round()), toBits(expected));
+
+  first.clear();
+  EXPECT_EQ(toBits(first.round()), 0u);
+  first.add(1.5f);
+  EXPECT_EQ(first.round(), 1.5f);
+}
+
+// the kernels of every instruction set leave the same digits
+TEST(ExactAccumulator, isa_kernels_agree) {
+  std::mt19937 rng(13);
+  const size_t count = 8 * 37 + 5;
+  std::vector<float> a(count), b(count);
+  for (size_t i = 0; i < count; ++i) {
+    a[i] = fromBits(rng());
+    b[i] = fromBits(rng());
+  }
+  // a few special lanes in the vector part
+  a[3] = INFINITY;
+  b[17] = NAN;
+
+  struct Kernels {
+    dispatch::Isa isa;
+    float (*sum)(int64_t *, const float *, size_t);
+    float (*dot)(int64_t *, const float *, const float *, size_t);
+  } kernels[] = {
+      {dispatch::Isa::Avx2, exactSumAccumulateAvx2, exactDotAccumulateAvx2},
+      {dispatch::Isa::Avx512, exactSumAccumulateAvx512,
+       exactDotAccumulateAvx512}};
+
+  // below, at and past the first full vector
+  for (size_t n : {size_t(0), size_t(7), size_t(8), count}) {
+    int64_t sumDigits[ExactAccumulator::DIGITS] = {};
+    int64_t dotDigits[ExactAccumulator::DIGITS] = {};
+    float sumSpecial = exactSumAccumulateScalar(sumDigits, a.data(), n);
+    float dotSpecial =
+        exactDotAccumulateScalar(dotDigits, a.data(), b.data(), n);
+    for (const Kernels &kernel : kernels) {
+      if (!dispatch::isaSupported(kernel.isa)) {
+        continue;
+      }
+      int64_t digits[ExactAccumulator::DIGITS] = {};
+      EXPECT_TRUE(sameFloat(kernel.sum(digits, a.data(), n), sumSpecial));
+      EXPECT_THAT(digits, ::testing::ElementsAreArray(sumDigits))
+          << dispatch::isaName(kernel.isa) << " " << n;
+      std::fill(digits, digits + ExactAccumulator::DIGITS, 0);
+      EXPECT_TRUE(
+          sameFloat(kernel.dot(digits, a.data(), b.data(), n), dotSpecial));
+      EXPECT_THAT(digits, ::testing::ElementsAreArray(dotDigits))
+          << dispatch::isaName(kernel.isa) << " " << n;
+    }
+  }
+}
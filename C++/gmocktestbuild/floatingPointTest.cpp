@@ -0,0 +1,195 @@
+#include "propertyTesting.h"
+
+#include "../floatingPoint/floatingPointSoftware.h"
+
+#include <gmock/gmock.h>
+
+#include <cstring>
+
+using property_testing::forAll;
+using property_testing::shrinkFloatBits;
+using property_testing::shrinkTuple;
+using property_testing::shrinkUnsigned;
+
+typedef std::tuple<uint32_t, uint32_t> FloatBits;
+
+static SWFloat fromBits(uint32_t bits) {
+  SWFloat value;
+  std::memcpy(&value, &bits, sizeof(bits));
+  return value;
+}
+
+static uint32_t toBits(SWFloat value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+static uint32_t toBits(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+// normal floats with the exponent in [65, 189], results of all the
+// operations stay normal which is what the soft float supports
+static bool inNormalDomain(const FloatBits &o) {
+  uint32_t ea = (std::get<0>(o) >> 23) & 0xFF;
+  uint32_t eb = (std::get<1>(o) >> 23) & 0xFF;
+  return ea >= 65 && ea <= 189 && eb >= 65 && eb <= 189;
+}
+
+static FloatBits randomNormal(std::mt19937 &rng) {
+  uint32_t a = (rng() & 0x807FFFFFu) | ((65 + rng() % 125) << 23);
+  uint32_t b = (rng() & 0x807FFFFFu) | ((65 + rng() % 125) << 23);
+  // close exponents exercise cancellation and rounding carries
+  if (rng() & 1) {
+    b = (b & 0x807FFFFFu) | (a & 0x7F800000u);
+  }
+  return FloatBits(a, b);
+}
+
+struct SoftOperation {
+  const char *name;
+  SWFloat (*soft)(SWFloat, SWFloat);
+  uint32_t (*softConstExpr)(uint32_t, uint32_t);
+  float (*hardware)(float, float);
+};
+
+std::ostream &operator<<(std::ostream &os, const SoftOperation &op) {
+  return os << op.name;
+}
+
+class SoftFloat : public ::testing::TestWithParam<SoftOperation> {};
+
+TEST_P(SoftFloat, matches_hardware) {
+  const SoftOperation op = GetParam();
+  EXPECT_TRUE(forAll(
+      randomNormal,
+      [](const FloatBits &o) { return shrinkTuple(o, shrinkFloatBits); },
+      inNormalDomain, [&op](const FloatBits &o) {
+        SWFloat a = fromBits(std::get<0>(o));
+        SWFloat b = fromBits(std::get<1>(o));
+        return toBits(op.soft(a, b)) ==
+               toBits(op.hardware(a.original, b.original));
+      },
+      100000));
+}
+
+TEST_P(SoftFloat, constexpr_is_bit_identical) {
+  const SoftOperation op = GetParam();
+  EXPECT_TRUE(forAll(
+      [](std::mt19937 &rng) { return FloatBits(rng(), rng()); },
+      [](const FloatBits &o) { return shrinkTuple(o, shrinkFloatBits); },
+      [](const FloatBits &) { return true; }, [&op](const FloatBits &o) {
+        uint32_t runtime =
+            toBits(op.soft(fromBits(std::get<0>(o)), fromBits(std::get<1>(o))));
+        return runtime == op.softConstExpr(std::get<0>(o), std::get<1>(o));
+      },
+      100000));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Operations, SoftFloat,
+    ::testing::Values(
+        SoftOperation{"addition", swFloatAddition, swFloatAdditionBitsConstExpr,
+                      [](float a, float b) { return a + b; }},
+        SoftOperation{"multiplication", swFloatMultiplication,
+                      swFloatMultiplicationBitsConstExpr,
+                      [](float a, float b) { return a * b; }},
+        SoftOperation{"division", swFloatDivision,
+                      swFloatDivisionBitsConstExpr,
+                      [](float a, float b) { return a / b; }}),
+    [](const ::testing::TestParamInfo<SoftOperation> &info) {
+      return std::string(info.param.name);
+    });
+
+TEST(SoftFloat, cancellation_gives_positive_zero) {
+  SWFloat a;
+  a.original = 3.25f;
+  SWFloat b;
+  b.original = -3.25f;
+  EXPECT_EQ(toBits(swFloatAddition(a, b)), 0u);
+}
+
+#ifdef __cpp_lib_bit_cast
+// the constexpr path has to stay a constant expression, calling it at
+// runtime only would not notice. Exact results, rounding is checked against
+// the runtime kernels below
+static_assert(swFloatAdditionConstExpr(1.5f, 2.25f) == 3.75f,
+              "constexpr soft float addition");
+static_assert(swFloatMultiplicationConstExpr(1.5f, -2.5f) == -3.75f,
+              "constexpr soft float multiplication");
+static_assert(swFloatDivisionConstExpr(3.0f, 0.75f) == 4.0f,
+              "constexpr soft float division");
+
+// tables baked at compile time, inexact operands so the rounding shows
+constexpr float tableOperand(size_t i) { return 1.0f + float(i) / 37.0f; }
+constexpr auto additionTable = generateSWFloatTable<64>([](size_t i) {
+  return swFloatAdditionConstExpr(tableOperand(i), 0.1f);
+});
+constexpr auto multiplicationTable = generateSWFloatTable<64>([](size_t i) {
+  return swFloatMultiplicationConstExpr(tableOperand(i), -0.3f);
+});
+constexpr auto reciprocalTable = generateSWFloatTable<64>([](size_t i) {
+  return swFloatDivisionConstExpr(1.0f, tableOperand(i));
+});
+
+TEST(SoftFloat, compile_time_tables_match_runtime) {
+  for (size_t i = 0; i < 64; ++i) {
+    SWFloat operand(tableOperand(i));
+    EXPECT_EQ(toBits(additionTable[i]),
+              toBits(swFloatAddition(operand, SWFloat(0.1f))))
+        << i;
+    EXPECT_EQ(toBits(multiplicationTable[i]),
+              toBits(swFloatMultiplication(operand, SWFloat(-0.3f))))
+        << i;
+    EXPECT_EQ(toBits(reciprocalTable[i]),
+              toBits(swFloatDivision(SWFloat(1.0f), operand)))
+        << i;
+  }
+}
+#endif
+
+TEST(findHighestBit, variants_agree) {
+  EXPECT_TRUE(forAll(
+      [](std::mt19937 &rng) { return rng() >> (rng() % 32); },
+      shrinkUnsigned, [](uint32_t v) { return v != 0; },
+      [](uint32_t v) {
+        uint32_t expected = findHighestBitFromRight(v);
+        return v == 0 ||
+               (findHighestBit(v) == expected &&
+                findHighestBitLeft(v) == expected &&
+                findHighestBitConstExpr(v) == expected);
+      }));
+  EXPECT_EQ(findHighestBitConstExpr(0), 0xFFFFFFFFu);
+}
+
+TEST(roundMantissa, variants_agree) {
+  // every grs combination for a spread of mantissas
+  for (uint32_t mantissa = 0; mantissa < (1u << 27); mantissa += 4093) {
+    for (uint32_t grs = 0; grs < 8; ++grs) {
+      uint32_t value = (mantissa & ~7u) | grs;
+      uint32_t expected = roundMantissa(value);
+      ASSERT_EQ(static_cast<uint32_t>(roundMantissaOneJump(value)), expected);
+      ASSERT_EQ(static_cast<uint32_t>(roundMantissaTwoJump(value)), expected);
+    }
+  }
+}
+
+TEST(normalize32BitMantissa, branchless_matches_jumps) {
+  // mantissas as produced by the soft float operations, at most 28 bits and
+  // with the highest bit not in the denormal range
+  EXPECT_TRUE(forAll(
+      [](std::mt19937 &rng) { return (rng() >> (4 + rng() % 24)) | 16u; },
+      shrinkUnsigned,
+      [](uint32_t v) { return v >= 16u && v < (1u << 28); },
+      [](uint32_t v) {
+        uint32_t branchless = v;
+        int jumps = static_cast<int>(v);
+        uint32_t bit = normalize32BitMantissaInPlace(branchless);
+        int bitJumps = normalize32BitMantissaInPlaceJumps(jumps);
+        return bit == static_cast<uint32_t>(bitJumps) &&
+               branchless == static_cast<uint32_t>(jumps);
+      }));
+}
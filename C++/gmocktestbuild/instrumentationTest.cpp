@@ -0,0 +1,138 @@
+#include "avx2Kernels.h"
+
+#include "../branchless/uv.h"
+#include "../branchless/uvBatch.h"
+#include "../dispatch/isaDispatch.h"
+#include "../floatingPoint/floatingPointSoftware.h"
+#include "../instrumentation/instrumentation.h"
+#include "../karatsuba/karatsuba.h"
+
+#include <gmock/gmock.h>
+
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using instrumentation::Counter;
+using instrumentation::CounterSnapshot;
+
+// the counters only ever grow and other tests run kernels too, everything is
+// checked as the difference between two snapshots
+static uint64_t delta(const CounterSnapshot &before,
+                      const CounterSnapshot &after, Counter counter) {
+  return after[counter] - before[counter];
+}
+
+static std::string readText(FILE *file) {
+  std::rewind(file);
+  std::string text;
+  char buffer[256];
+  while (std::fgets(buffer, sizeof(buffer), file)) {
+    text += buffer;
+  }
+  return text;
+}
+
+TEST(Instrumentation, soft_float_counts_calls_rounding_and_denormals) {
+  if (!instrumentation::enabled()) {
+    GTEST_SKIP() << "built without KERNELS_INSTRUMENT";
+  }
+  SWFloat one;
+  one.original = 1.0f;
+  SWFloat tiny;
+  tiny.original = 1.0f / (1 << 30);
+  SWFloat minusOne;
+  minusOne.original = -1.0f;
+
+  CounterSnapshot before = instrumentation::snapshotCounters();
+  // tiny is way below the last mantissa bit, only the sticky bit is left
+  swFloatAddition(one, tiny);
+  swFloatMultiplication(one, one);
+  CounterSnapshot middle = instrumentation::snapshotCounters();
+  // nothing left to normalize, flushed to zero
+  swFloatAddition(one, minusOne);
+  CounterSnapshot after = instrumentation::snapshotCounters();
+
+  EXPECT_EQ(delta(before, middle, Counter::SoftFloatCalls), 2u);
+  EXPECT_EQ(delta(before, middle, Counter::SoftFloatRounding), 1u);
+  EXPECT_EQ(delta(before, middle, Counter::SoftFloatDenormals), 0u);
+  EXPECT_EQ(delta(middle, after, Counter::SoftFloatCalls), 1u);
+  EXPECT_EQ(delta(middle, after, Counter::SoftFloatDenormals), 1u);
+}
+
+TEST(Instrumentation, karatsuba_counts_calls_and_the_depth) {
+  if (!instrumentation::enabled()) {
+    GTEST_SKIP() << "built without KERNELS_INSTRUMENT";
+  }
+  CounterSnapshot before = instrumentation::snapshotCounters();
+  EXPECT_EQ(cpp_tools::algorithms::karatsuba(1234, 4321, 32), 1234u * 4321u);
+  CounterSnapshot after = instrumentation::snapshotCounters();
+  EXPECT_EQ(delta(before, after, Counter::KaratsubaCalls), 1u);
+  // 32, 16, 8 and the 4 bits leaves
+  EXPECT_GE(after[Counter::KaratsubaDepth], 4u);
+}
+
+TEST(Instrumentation, uv_kernels_count_pairs) {
+  if (!instrumentation::enabled()) {
+    GTEST_SKIP() << "built without KERNELS_INSTRUMENT";
+  }
+  std::vector<float> uvs(2 * 100, 0.25f);
+  std::vector<float> out(uvs.size());
+  CounterSnapshot before = instrumentation::snapshotCounters();
+  offsetUVsBatch(uvs.data(), out.data(), 100);
+  offsetUVsNoBranch3(uvs.data(), out.data());
+  const bool avx2 = dispatch::isaSupported(dispatch::Isa::Avx2);
+  if (avx2) {
+    avx2_kernels::offsetUVsNoBranch2(uvs.data(), out.data());
+  }
+  CounterSnapshot after = instrumentation::snapshotCounters();
+  EXPECT_EQ(delta(before, after, Counter::UVOffsetPairs), avx2 ? 102u : 101u);
+  EXPECT_EQ(delta(before, after, Counter::Compress256Calls), avx2 ? 1u : 0u);
+}
+
+TEST(Instrumentation, finished_threads_are_still_counted) {
+  if (!instrumentation::enabled()) {
+    GTEST_SKIP() << "built without KERNELS_INSTRUMENT";
+  }
+  CounterSnapshot before = instrumentation::snapshotCounters();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([]() {
+      instrumentation::registerThisThread();
+      float uv[2] = {0.1f, 0.7f};
+      float out[2];
+      for (int i = 0; i < 1000; ++i) {
+        offsetUVsNoBranch3(uv, out);
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  CounterSnapshot after = instrumentation::snapshotCounters();
+  EXPECT_EQ(delta(before, after, Counter::UVOffsetPairs), 4000u);
+}
+
+TEST(Instrumentation, chrome_trace_has_the_scopes_and_the_counters) {
+  std::vector<float> uvs(2 * 64, 0.25f);
+  std::vector<float> out(uvs.size());
+  offsetUVsBatch(uvs.data(), out.data(), 64);
+
+  FILE *file = std::tmpfile();
+  ASSERT_TRUE(instrumentation::writeChromeTrace(file));
+  std::string text = readText(file);
+  std::fclose(file);
+
+  EXPECT_THAT(text, ::testing::StartsWith("{\"displayTimeUnit\":\"ns\","
+                                          "\"traceEvents\":["));
+  if (instrumentation::enabled()) {
+    EXPECT_GT(instrumentation::traceEventCount(), 0u);
+    EXPECT_THAT(text, ::testing::HasSubstr(
+                          "{\"name\":\"offsetUVsBatch\",\"cat\":\"kernels\","
+                          "\"ph\":\"X\""));
+    EXPECT_THAT(text, ::testing::HasSubstr("\"uvOffsetPairs\":"));
+  } else {
+    EXPECT_THAT(text, ::testing::HasSubstr("\"traceEvents\":[]"));
+  }
+}
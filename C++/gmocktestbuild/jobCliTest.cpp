@@ -0,0 +1,79 @@
+#include <jobcli.h>
+
+#include <gmock/gmock.h>
+
+#include <cstdio>
+#include <string>
+
+using namespace kernel_console;
+
+TEST(JobCli, parses_the_job_and_skips_gui_options) {
+  const char *argv[] = {"qttest",   "--headless", "-platform", "offscreen",
+                        "--job",    "uvmesh",     "--size",    "1234",
+                        "--workers", "2",         "--progress",
+                        "--trace",  "out.json"};
+  JobOptions options;
+  std::string error;
+  ASSERT_TRUE(parseJobOptions(13, argv, options, error)) << error;
+  EXPECT_EQ(options.job, "uvmesh");
+  EXPECT_EQ(options.benchmark.inputSize, 1234u);
+  EXPECT_EQ(options.workers, 2u);
+  EXPECT_TRUE(options.progress);
+  EXPECT_EQ(options.tracePath, "out.json");
+}
+
+TEST(JobCli, rejects_bad_command_lines) {
+  const char *unknownJob[] = {"jobcli", "--job", "nope"};
+  const char *unknownKernel[] = {"jobcli", "--kernel", "nope"};
+  const char *zeroSize[] = {"jobcli", "--size", "0"};
+  const char *missingValue[] = {"jobcli", "--threads"};
+  JobOptions options;
+  std::string error;
+  EXPECT_FALSE(parseJobOptions(3, unknownJob, options, error));
+  EXPECT_FALSE(parseJobOptions(3, unknownKernel, options, error));
+  EXPECT_FALSE(parseJobOptions(3, zeroSize, options, error));
+  EXPECT_FALSE(parseJobOptions(2, missingValue, options, error));
+}
+
+// everything written to out by runJobs
+std::string runToString(const JobOptions &options, int &code) {
+  FILE *file = std::tmpfile();
+  code = runJobs(options, file);
+  std::rewind(file);
+  std::string text;
+  char buffer[256];
+  while (std::fgets(buffer, sizeof(buffer), file)) {
+    text += buffer;
+  }
+  std::fclose(file);
+  return text;
+}
+
+TEST(JobCli, benchmark_prints_one_line_per_sample_and_the_result) {
+  const char *argv[] = {"jobcli", "--kernel", "karatsubaUnrolled",
+                        "--size", "500",      "--samples",
+                        "3"};
+  JobOptions options;
+  std::string error;
+  ASSERT_TRUE(parseJobOptions(7, argv, options, error)) << error;
+  int code = -1;
+  std::string text = runToString(options, code);
+  EXPECT_EQ(code, 0);
+  size_t samples = 0;
+  for (size_t at = text.find("\nsample,"); at != std::string::npos;
+       at = text.find("\nsample,", at + 1)) {
+    ++samples;
+  }
+  EXPECT_EQ(samples, 3u);
+  EXPECT_THAT(text, ::testing::HasSubstr("\nresult,1,1,"));
+}
+
+TEST(JobCli, sweep_result_has_no_failures) {
+  JobOptions options;
+  options.job = "mul-sweep";
+  options.benchmark.inputSize = 5000;
+  int code = -1;
+  std::string text = runToString(options, code);
+  EXPECT_EQ(code, 0);
+  EXPECT_THAT(text, ::testing::HasSubstr(",5000,0,"));
+}
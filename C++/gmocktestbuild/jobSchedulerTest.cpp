@@ -0,0 +1,191 @@
+#include <jobs.h>
+#include <jobscheduler.h>
+#include <spscqueue.h>
+
+#include <gmock/gmock.h>
+
+#include <map>
+#include <thread>
+#include <vector>
+
+using namespace kernel_console;
+
+TEST(SpscQueue, fills_up_and_drains_in_order) {
+  SpscQueue<int, 4> queue;
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_TRUE(queue.tryPush(i));
+  }
+  EXPECT_FALSE(queue.tryPush(4));
+  int value = -1;
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue.tryPop(value));
+    EXPECT_EQ(value, i);
+  }
+  EXPECT_FALSE(queue.tryPop(value));
+}
+
+TEST(SpscQueue, two_threads_see_every_value_once) {
+  const uint64_t count = 200000;
+  static SpscQueue<uint64_t, 256> queue;
+  std::thread producer([] {
+    for (uint64_t i = 0; i < count; ++i) {
+      while (!queue.tryPush(i)) {
+        std::this_thread::yield();
+      }
+    }
+  });
+  uint64_t expected = 0;
+  uint64_t value;
+  while (expected < count) {
+    if (queue.tryPop(value)) {
+      ASSERT_EQ(value, expected);
+      ++expected;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  EXPECT_EQ(queue.sizeApprox(), 0u);
+}
+
+// events of a job, in arrival order
+std::map<uint32_t, std::vector<JobEvent>> drain(JobScheduler &scheduler) {
+  std::map<uint32_t, std::vector<JobEvent>> events;
+  while (scheduler.pending()) {
+    scheduler.poll([&](const JobEvent &event) {
+      events[event.job].push_back(event);
+    });
+    std::this_thread::yield();
+  }
+  return events;
+}
+
+TEST(JobScheduler, every_job_ends_with_its_result_then_finished) {
+  JobScheduler scheduler(3);
+  std::vector<uint32_t> ids;
+  for (int i = 0; i < 10; ++i) {
+    ids.push_back(scheduler.submit([i](JobContext &context) {
+      context.progress(1, 2);
+      context.result(i, 0, 0.0);
+    }));
+  }
+  scheduler.waitIdle();
+  auto events = drain(scheduler);
+  ASSERT_EQ(events.size(), ids.size());
+  for (size_t i = 0; i < ids.size(); ++i) {
+    const std::vector<JobEvent> &job = events[ids[i]];
+    ASSERT_GE(job.size(), 2u);
+    EXPECT_EQ(job[job.size() - 2].kind, JobEvent::Result);
+    EXPECT_EQ(job[job.size() - 2].items, i);
+    EXPECT_EQ(job.back().kind, JobEvent::Finished);
+  }
+}
+
+TEST(JobScheduler, progress_is_throttled) {
+  JobScheduler scheduler(1, std::chrono::milliseconds(1000));
+  uint32_t id = scheduler.submit([](JobContext &context) {
+    for (int i = 0; i < 100000; ++i) {
+      context.progress(i, 100000);
+    }
+    context.progress(100000, 100000);
+  });
+  auto events = drain(scheduler);
+  size_t progress = 0;
+  for (const JobEvent &event : events[id]) {
+    progress += event.kind == JobEvent::Progress;
+  }
+  // the first one and the completion
+  EXPECT_LE(progress, 3u);
+  EXPECT_EQ(events[id].back().kind, JobEvent::Finished);
+}
+
+TEST(JobScheduler, cancel_reaches_running_and_queued_jobs) {
+  JobScheduler scheduler(1);
+  std::atomic<bool> started(false);
+  uint32_t running = scheduler.submit([&](JobContext &context) {
+    started = true;
+    while (!context.cancelled()) {
+      std::this_thread::yield();
+    }
+  });
+  bool ran = false;
+  uint32_t queued = scheduler.submit([&](JobContext &) { ran = true; });
+  while (!started) {
+    std::this_thread::yield();
+  }
+  scheduler.cancelAll();
+  auto events = drain(scheduler);
+  EXPECT_EQ(events[running].back().kind, JobEvent::Cancelled);
+  EXPECT_EQ(events[queued].back().kind, JobEvent::Cancelled);
+  EXPECT_FALSE(ran);
+}
+
+TEST(JobScheduler, nobody_polling_does_not_block_shutdown) {
+  JobScheduler scheduler(2);
+  for (int i = 0; i < 4; ++i) {
+    scheduler.submit([](JobContext &context) {
+      for (size_t j = 0; j < 4 * JobScheduler::EVENT_QUEUE_SIZE; ++j) {
+        context.sample(BenchmarkSample());
+      }
+    });
+  }
+  // the samples that do not fit go to the overflow lists, nothing waits
+}
+
+TEST(JobScheduler, wait_idle_without_polling_past_a_full_queue) {
+  JobScheduler scheduler(2);
+  const size_t samples = 3 * JobScheduler::EVENT_QUEUE_SIZE + 5;
+  std::vector<uint32_t> ids;
+  for (int i = 0; i < 3; ++i) {
+    ids.push_back(scheduler.submit([samples](JobContext &context) {
+      for (size_t j = 0; j < samples; ++j) {
+        BenchmarkSample sample;
+        sample.index = unsigned(j);
+        context.sample(sample);
+      }
+      context.result(samples, 0, 0.0);
+    }));
+  }
+  scheduler.waitIdle();
+  auto events = drain(scheduler);
+  for (uint32_t id : ids) {
+    const std::vector<JobEvent> &job = events[id];
+    ASSERT_EQ(job.size(), samples + 2);
+    for (size_t j = 0; j < samples; ++j) {
+      ASSERT_EQ(job[j].kind, JobEvent::Sample);
+      ASSERT_EQ(job[j].sample.index, j);
+    }
+    EXPECT_EQ(job[samples].kind, JobEvent::Result);
+    EXPECT_EQ(job.back().kind, JobEvent::Finished);
+  }
+}
+
+TEST(Jobs, soft_float_sweeps_match_the_hardware) {
+  JobScheduler scheduler(3);
+  uint32_t add = scheduler.submit(softFloatSweepJob(SoftFloatOperation::Addition, 100000));
+  uint32_t mul = scheduler.submit(softFloatSweepJob(SoftFloatOperation::Multiplication, 100000));
+  uint32_t div = scheduler.submit(softFloatSweepJob(SoftFloatOperation::Division, 100000));
+  auto events = drain(scheduler);
+  for (uint32_t id : {add, mul, div}) {
+    const JobEvent &result = events[id][events[id].size() - 2];
+    ASSERT_EQ(result.kind, JobEvent::Result);
+    EXPECT_EQ(result.items, 100000u);
+    EXPECT_EQ(result.failures, 0u);
+  }
+}
+
+TEST(Jobs, uv_mesh_and_benchmark_report_what_they_ran) {
+  JobScheduler scheduler(2);
+  uint32_t mesh = scheduler.submit(uvMeshJob(300000));
+  BenchmarkConfig config;
+  config.inputSize = 1000;
+  config.samples = 4;
+  uint32_t bench = scheduler.submit(benchmarkJob(config));
+  auto events = drain(scheduler);
+  EXPECT_EQ(events[mesh][events[mesh].size() - 2].items, 300000u);
+  size_t samples = 0;
+  for (const JobEvent &event : events[bench]) {
+    samples += event.kind == JobEvent::Sample;
+  }
+  EXPECT_EQ(samples, 4u);
+}
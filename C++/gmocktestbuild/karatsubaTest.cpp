@@ -0,0 +1,273 @@
+#include "propertyTesting.h"
+
+#include "../karatsuba/karatsubaMultiLimb.h"
+#include "../karatsuba/modular.h"
+
+#include <gmock/gmock.h>
+
+using namespace cpp_tools::algorithms;
+using property_testing::forAll;
+using property_testing::shrinkTuple;
+using property_testing::shrinkUnsigned;
+
+typedef std::tuple<uint32_t, uint32_t> Operands;
+
+struct Multiplier {
+  const char *name;
+  uint32_t (*function)(uint32_t, uint32_t);
+  uint32_t bits;
+};
+
+std::ostream &operator<<(std::ostream &os, const Multiplier &m) {
+  return os << m.name << "<" << m.bits << ">";
+}
+
+class KaratsubaProduct : public ::testing::TestWithParam<Multiplier> {};
+
+TEST_P(KaratsubaProduct, matches_native_product) {
+  const Multiplier m = GetParam();
+  const uint32_t mask = m.bits == 32 ? ~0u : (1u << m.bits) - 1;
+  auto inDomain = [mask](const Operands &o) {
+    return (std::get<0>(o) & ~mask) == 0 && (std::get<1>(o) & ~mask) == 0;
+  };
+  EXPECT_TRUE(forAll(
+      [mask](std::mt19937 &rng) {
+        return Operands(rng() & mask, rng() & mask);
+      },
+      [](const Operands &o) { return shrinkTuple(o, shrinkUnsigned); },
+      inDomain,
+      [&m](const Operands &o) {
+        uint32_t x = std::get<0>(o);
+        uint32_t y = std::get<1>(o);
+        return m.function(x, y) == x * y;
+      }));
+}
+
+TEST_P(KaratsubaProduct, edge_operands) {
+  const Multiplier m = GetParam();
+  const uint32_t mask = m.bits == 32 ? ~0u : (1u << m.bits) - 1;
+  const uint32_t values[] = {0u, 1u, 2u, mask, mask >> 1, mask - 1};
+  for (uint32_t x : values) {
+    for (uint32_t y : values) {
+      EXPECT_EQ(m.function(x, y), x * y) << x << " * " << y;
+    }
+  }
+}
+
+static uint32_t karatsuba8(uint32_t x, uint32_t y) {
+  return karatsuba(x, y, 8);
+}
+static uint32_t karatsuba16(uint32_t x, uint32_t y) {
+  return karatsuba(x, y, 16);
+}
+static uint32_t karatsuba32(uint32_t x, uint32_t y) {
+  return karatsuba(x, y, 32);
+}
+static uint32_t karatsubaConstExpr16(uint32_t x, uint32_t y) {
+  return karatsubaConstExpr(x, y, 16);
+}
+static uint32_t karatsubaConstExpr32(uint32_t x, uint32_t y) {
+  return karatsubaConstExpr(x, y, 32);
+}
+static uint32_t karatsubaTemplate16(uint32_t x, uint32_t y) {
+  return karatsubaTemplate<16>(x, y);
+}
+static uint32_t karatsubaTemplate32(uint32_t x, uint32_t y) {
+  return karatsubaTemplate<32>(x, y);
+}
+static uint32_t karatsubaUnrolled4(uint32_t x, uint32_t y) {
+  return karatsubaUnrolled<4>(x, y);
+}
+static uint32_t karatsubaUnrolled11(uint32_t x, uint32_t y) {
+  return karatsubaUnrolled<11>(x, y);
+}
+static uint32_t karatsubaUnrolled16(uint32_t x, uint32_t y) {
+  return karatsubaUnrolled<16>(x, y);
+}
+static uint32_t karatsubaUnrolled32(uint32_t x, uint32_t y) {
+  return karatsubaUnrolled<32>(x, y);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Variants, KaratsubaProduct,
+    ::testing::Values(
+        Multiplier{"karatsuba", karatsuba8, 8},
+        Multiplier{"karatsuba", karatsuba16, 16},
+        Multiplier{"karatsuba", karatsuba32, 32},
+        Multiplier{"karatsubaConstExpr", karatsubaConstExpr16, 16},
+        Multiplier{"karatsubaConstExpr", karatsubaConstExpr32, 32},
+        Multiplier{"karatsubaTemplate", karatsubaTemplate16, 16},
+        Multiplier{"karatsubaTemplate", karatsubaTemplate32, 32},
+        Multiplier{"karatsubaUnrolled", karatsubaUnrolled4, 4},
+        Multiplier{"karatsubaUnrolled", karatsubaUnrolled11, 11},
+        Multiplier{"karatsubaUnrolled", karatsubaUnrolled16, 16},
+        Multiplier{"karatsubaUnrolled", karatsubaUnrolled32, 32}));
+
+static_assert(karatsubaConstExpr(1234, 5678, 16) == 1234 * 5678,
+              "constexpr karatsuba");
+
+TEST(karatsubaWide, matches_native_product) {
+  EXPECT_TRUE(forAll(
+      [](std::mt19937 &rng) { return Operands(rng(), rng()); },
+      [](const Operands &o) { return shrinkTuple(o, shrinkUnsigned); },
+      [](const Operands &) { return true; },
+      [](const Operands &o) {
+        return karatsubaWide(std::get<0>(o), std::get<1>(o)) ==
+               static_cast<uint64_t>(std::get<0>(o)) * std::get<1>(o);
+      }));
+}
+
+static uint32_t referencePower(uint64_t base, uint64_t exponent,
+                               uint64_t modulus) {
+  uint64_t result = 1 % modulus;
+  base %= modulus;
+  while (exponent) {
+    result = (exponent & 1) ? (result * base) % modulus : result;
+    base = (base * base) % modulus;
+    exponent >>= 1;
+  }
+  return static_cast<uint32_t>(result);
+}
+
+typedef std::tuple<uint32_t, uint32_t, uint32_t, uint32_t> ModularOperands;
+
+// modulus, a, b, exponent, the operands get reduced by the property itself
+static ModularOperands randomModular(std::mt19937 &rng) {
+  return ModularOperands(rng() >> (rng() % 30), rng(), rng(), rng() % 5000);
+}
+
+TEST(Montgomery32, matches_reference) {
+  EXPECT_TRUE(forAll(
+      randomModular,
+      [](const ModularOperands &o) { return shrinkTuple(o, shrinkUnsigned); },
+      [](const ModularOperands &o) { return std::get<0>(o) >= 2; },
+      [](const ModularOperands &o) {
+        uint32_t n = std::get<0>(o) | 1;
+        uint32_t a = std::get<1>(o) % n;
+        uint32_t b = std::get<2>(o) % n;
+        Montgomery32<> m(n);
+        return m.modMultiply(a, b) == static_cast<uint64_t>(a) * b % n &&
+               m.modPower(a, std::get<3>(o)) ==
+                   referencePower(a, std::get<3>(o), n) &&
+               m.fromMontgomery(m.toMontgomery(a)) == a;
+      },
+      2000));
+}
+
+TEST(Barrett32, matches_reference) {
+  EXPECT_TRUE(forAll(
+      randomModular,
+      [](const ModularOperands &o) { return shrinkTuple(o, shrinkUnsigned); },
+      [](const ModularOperands &o) { return std::get<0>(o) >= 2; },
+      [](const ModularOperands &o) {
+        uint32_t n = std::get<0>(o) < 2 ? 2 : std::get<0>(o);
+        uint32_t a = std::get<1>(o) % n;
+        uint32_t b = std::get<2>(o) % n;
+        Barrett32<NativeWideMultiply> barrett(n);
+        return barrett.modMultiply(a, b) ==
+                   static_cast<uint64_t>(a) * b % n &&
+               barrett.modPower(a, std::get<3>(o)) ==
+                   referencePower(a, std::get<3>(o), n);
+      },
+      2000));
+}
+
+// the base of modPower is not expected to be reduced, with both multiplies
+template <typename WideMultiply> static void checkUnreducedBase() {
+  EXPECT_EQ(Barrett32<WideMultiply>(1000003).modPower(0xFFFFFFF0u, 3),
+            729053u);
+  // the biggest quotients reduce has to estimate, the base is far above N^2
+  for (uint32_t n : {2u, 3u, 0xFFFFFFFFu, 0xFFFFFFFEu}) {
+    EXPECT_EQ(Barrett32<WideMultiply>(n).modPower(0xFFFFFFFFu, 1),
+              0xFFFFFFFFu % n)
+        << n;
+  }
+  EXPECT_TRUE(forAll(
+      randomModular,
+      [](const ModularOperands &o) { return shrinkTuple(o, shrinkUnsigned); },
+      [](const ModularOperands &o) { return std::get<0>(o) >= 2; },
+      [](const ModularOperands &o) {
+        uint32_t n = std::get<0>(o) < 2 ? 2 : std::get<0>(o);
+        uint32_t base = std::get<1>(o) | n;
+        return Barrett32<WideMultiply>(n).modPower(base, std::get<3>(o)) ==
+               referencePower(base, std::get<3>(o), n);
+      },
+      2000));
+}
+
+TEST(Barrett32, power_of_unreduced_base) {
+  checkUnreducedBase<NativeWideMultiply>();
+  checkUnreducedBase<KaratsubaWideMultiply>();
+}
+
+TEST(Montgomery32, batches_match_single_calls) {
+  Montgomery32<> m(1000000007u);
+  std::vector<uint32_t> a(64), b(64), out(64), powOut(64);
+  std::vector<uint64_t> exponents(64);
+  std::mt19937 rng(property_testing::seed());
+  for (size_t i = 0; i < a.size(); ++i) {
+    a[i] = rng() % m.modulus();
+    b[i] = rng() % m.modulus();
+    exponents[i] = rng();
+  }
+  m.modMultiplyBatch(a.data(), b.data(), out.data(), a.size());
+  m.modPowerBatch(a.data(), exponents.data(), powOut.data(), a.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    EXPECT_EQ(out[i], m.modMultiply(a[i], b[i]));
+    EXPECT_EQ(powOut[i], referencePower(a[i], exponents[i], m.modulus()));
+  }
+}
+
+TEST(MontgomeryMultiLimb, matches_two_limbs_reference) {
+  std::mt19937_64 rng(property_testing::seed());
+  for (int i = 0; i < 500; ++i) {
+    uint64_t n = (rng() >> (rng() % 40)) | 1;
+    n = n < 3 ? 3 : n;
+    MontgomeryMultiLimb<2> m({uint32_t(n), uint32_t(n >> 32)});
+    uint64_t a = rng() % n;
+    uint64_t b = rng() % n;
+    auto result = m.modMultiply({uint32_t(a), uint32_t(a >> 32)},
+                                {uint32_t(b), uint32_t(b >> 32)});
+    unsigned __int128 expected = (unsigned __int128)a * b % n;
+    EXPECT_EQ(result[0] | (uint64_t(result[1]) << 32), uint64_t(expected));
+  }
+}
+
+class MultiLimbKaratsuba : public ::testing::TestWithParam<size_t> {};
+
+TEST_P(MultiLimbKaratsuba, matches_schoolbook_and_plan) {
+  const size_t limbs = GetParam();
+  std::mt19937 rng(property_testing::seed());
+  std::vector<uint32_t> x(limbs), y(limbs), expected(2 * limbs),
+      result(2 * limbs);
+  for (size_t i = 0; i < limbs; ++i) {
+    x[i] = rng();
+    // all ones maximizes the carries
+    y[i] = (limbs % 2) ? 0xFFFFFFFFu : rng();
+  }
+  schoolbookMultiLimb(x.data(), y.data(), limbs, expected.data());
+
+  std::vector<uint32_t> scratch(karatsubaScratchLimbs(limbs));
+  ScratchArena arena(scratch.data(), scratch.size());
+  karatsubaMultiLimb(x.data(), y.data(), limbs, result.data(), arena);
+  EXPECT_EQ(result, expected);
+  EXPECT_EQ(arena.used(), 0u);
+  EXPECT_EQ(arena.highWater(), scratch.size());
+}
+
+TEST(MultiLimbKaratsubaArena, rejects_too_small_arena) {
+  const size_t limbs = 64;
+  std::vector<uint32_t> x(limbs, 1), y(limbs, 1), result(2 * limbs);
+  std::vector<uint32_t> scratch(karatsubaScratchLimbs(limbs));
+  ScratchArena arena(scratch.data(), scratch.size());
+  // one limb already in use is enough to not fit anymore
+  arena.allocate(1);
+  EXPECT_THROW(
+      karatsubaMultiLimb(x.data(), y.data(), limbs, result.data(), arena),
+      std::length_error);
+  EXPECT_EQ(arena.used(), 1u);
+  EXPECT_EQ(arena.highWater(), 1u);
+}
+
+INSTANTIATE_TEST_SUITE_P(Sizes, MultiLimbKaratsuba,
+                         ::testing::Values(1, 7, 16, 17, 33, 64, 101, 256));
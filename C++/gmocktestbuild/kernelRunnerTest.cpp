@@ -0,0 +1,85 @@
+#include <kernelrunner.h>
+
+#include "../dispatch/isaDispatch.h"
+
+#include <gmock/gmock.h>
+
+#include <string>
+#include <vector>
+
+using namespace kernel_console;
+
+TEST(KernelRunner, percentile_picks_nearest_rank) {
+  std::vector<double> values;
+  for (int i = 100; i >= 0; --i) {
+    values.push_back(i);
+  }
+  EXPECT_EQ(percentile(values, 50.0), 50.0);
+  EXPECT_EQ(percentile(values, 90.0), 90.0);
+  EXPECT_EQ(percentile(values, 99.0), 99.0);
+  EXPECT_EQ(percentile(values, 100.0), 100.0);
+  std::vector<double> empty;
+  EXPECT_EQ(percentile(empty, 50.0), 0.0);
+}
+
+TEST(KernelRunner, every_kernel_produces_the_requested_samples) {
+  ASSERT_FALSE(availableKernels().empty());
+  for (size_t kernel = 0; kernel < availableKernels().size(); ++kernel) {
+    BenchmarkConfig config;
+    config.kernelIndex = kernel;
+    // not a multiple of the chunk, the last chunk is partial
+    config.inputSize = 1000;
+    config.threads = 2;
+    config.samples = 3;
+    std::vector<BenchmarkSample> samples;
+    runBenchmark(config, [&](const BenchmarkSample &sample) {
+      samples.push_back(sample);
+    });
+    ASSERT_EQ(samples.size(), 3u) << availableKernels()[kernel].name;
+    for (unsigned i = 0; i < samples.size(); ++i) {
+      EXPECT_EQ(samples[i].index, i);
+      EXPECT_GT(samples[i].throughput, 0.0);
+      EXPECT_LE(samples[i].latencyP50, samples[i].latencyP90);
+      EXPECT_LE(samples[i].latencyP90, samples[i].latencyP99);
+    }
+  }
+}
+
+// the single call kernels are listed once per instruction set of the cpu,
+// the bmi2 uv kernels only from avx2 on
+TEST(KernelRunner, single_call_kernels_for_every_supported_isa) {
+  std::vector<std::string> names;
+  for (const KernelInfo &kernel : availableKernels()) {
+    names.push_back(kernel.name);
+  }
+  using ::testing::Contains;
+  using ::testing::Not;
+  EXPECT_THAT(names, Contains("swFloatDivision (scalar)"));
+  EXPECT_THAT(names, Contains("offsetUVs (scalar)"));
+  EXPECT_THAT(names, Not(Contains("offsetUVsNoBranch1 (scalar)")));
+  for (dispatch::Isa isa : {dispatch::Isa::Avx2, dispatch::Isa::Avx512}) {
+    const std::string suffix = std::string(" (") + dispatch::isaName(isa) + ")";
+    auto listed = Contains("offsetUVsNoBranch1" + suffix);
+    if (dispatch::isaSupported(isa)) {
+      EXPECT_THAT(names, listed);
+      EXPECT_THAT(names, Contains("swFloatDivision" + suffix));
+    } else {
+      EXPECT_THAT(names, Not(listed));
+    }
+  }
+}
+
+TEST(KernelRunner, cancel_stops_after_the_current_sample) {
+  std::atomic<bool> cancel(false);
+  BenchmarkConfig config;
+  config.inputSize = 256;
+  config.threads = 3;
+  config.samples = 1000000;
+  unsigned count = 0;
+  runBenchmark(config, [&](const BenchmarkSample &) {
+    if (++count == 5) {
+      cancel = true;
+    }
+  }, &cancel);
+  EXPECT_EQ(count, 5u);
+}
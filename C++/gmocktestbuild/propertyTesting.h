@@ -0,0 +1,130 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Minimal property based testing on top of gtest. A property is checked on
+// randomly generated inputs, when it fails the input gets shrunk: we keep
+// trying simpler candidates and move to the first one that still fails,
+// until none does, the smallest failing input is the one reported.
+// The seed can be forced with the PROPERTY_SEED environment variable to
+// replay a failure.
+
+namespace property_testing {
+
+inline uint32_t seed() {
+  const char *env = std::getenv("PROPERTY_SEED");
+  return env ? static_cast<uint32_t>(std::strtoul(env, nullptr, 10))
+             : 0x5eed1234u;
+}
+
+// simpler candidates for an unsigned value, zero first, then halving, then
+// clearing bits from the top
+inline std::vector<uint32_t> shrinkUnsigned(uint32_t value) {
+  std::vector<uint32_t> candidates;
+  if (value == 0) {
+    return candidates;
+  }
+  candidates.push_back(0);
+  candidates.push_back(value >> 1);
+  candidates.push_back(value - 1);
+  for (int bit = 31; bit >= 0; --bit) {
+    if (value & (1u << bit)) {
+      candidates.push_back(value & ~(1u << bit));
+    }
+  }
+  return candidates;
+}
+
+// simpler candidates for a float given as bits, moving the exponent toward
+// 127 (one) and clearing mantissa bits, the sign is left alone, the caller
+// filter decides if a candidate is still in the domain of the property
+inline std::vector<uint32_t> shrinkFloatBits(uint32_t value) {
+  std::vector<uint32_t> candidates;
+  uint32_t sign = value & 0x80000000u;
+  uint32_t exponent = (value >> 23) & 0xFF;
+  uint32_t mantissa = value & 0x7FFFFF;
+  if (exponent != 127) {
+    uint32_t closer = exponent > 127 ? exponent - 1 : exponent + 1;
+    candidates.push_back(sign | (127u << 23) | mantissa);
+    candidates.push_back(sign | (closer << 23) | mantissa);
+  }
+  for (uint32_t m : shrinkUnsigned(mantissa)) {
+    candidates.push_back(sign | (exponent << 23) | m);
+  }
+  return candidates;
+}
+
+// shrinks one element of the tuple at the time
+template <size_t I = 0, typename Tuple, typename Shrinker>
+void shrinkElements(const Tuple &value, Shrinker shrinker,
+                    std::vector<Tuple> &out) {
+  if constexpr (I < std::tuple_size<Tuple>::value) {
+    for (auto candidate : shrinker(std::get<I>(value))) {
+      Tuple copy = value;
+      std::get<I>(copy) = candidate;
+      out.push_back(copy);
+    }
+    shrinkElements<I + 1>(value, shrinker, out);
+  }
+}
+
+template <typename Tuple, typename Shrinker>
+std::vector<Tuple> shrinkTuple(const Tuple &value, Shrinker shrinker) {
+  std::vector<Tuple> out;
+  shrinkElements(value, shrinker, out);
+  return out;
+}
+
+template <typename T> std::string describe(const T &value) {
+  return ::testing::PrintToString(value);
+}
+
+// generator(rng) -> Value, shrink(value) -> std::vector<Value>,
+// inDomain(value) -> bool filters shrunk candidates,
+// property(value) -> bool
+template <typename Generator, typename Shrink, typename InDomain,
+          typename Property>
+::testing::AssertionResult forAll(Generator generator, Shrink shrink,
+                                  InDomain inDomain, Property property,
+                                  int iterations = 10000) {
+  const uint32_t currentSeed = seed();
+  std::mt19937 rng(currentSeed);
+  for (int i = 0; i < iterations; ++i) {
+    auto value = generator(rng);
+    if (property(value)) {
+      continue;
+    }
+
+    auto original = value;
+    int steps = 0;
+    bool shrunk = true;
+    while (shrunk && steps < 1000) {
+      shrunk = false;
+      for (const auto &candidate : shrink(value)) {
+        if (inDomain(candidate) && !property(candidate)) {
+          value = candidate;
+          shrunk = true;
+          ++steps;
+          break;
+        }
+      }
+    }
+
+    std::ostringstream message;
+    message << "property failed at iteration " << i << " (PROPERTY_SEED="
+            << currentSeed << ")\n  original: " << describe(original)
+            << "\n  shrunk (" << steps << " steps): " << describe(value);
+    return ::testing::AssertionFailure() << message.str();
+  }
+  return ::testing::AssertionSuccess();
+}
+
+} // namespace property_testing
@@ -0,0 +1,242 @@
+#include "avx2Test.h"
+#include "propertyTesting.h"
+
+#include "../floatingPoint/floatingPointSoftware.h"
+#include "../floatingPoint/softFloatBatch.h"
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using property_testing::forAll;
+using property_testing::shrinkFloatBits;
+using property_testing::shrinkTuple;
+
+typedef std::tuple<uint32_t, uint32_t> FloatBits;
+
+static SWFloat fromBits(uint32_t bits) {
+  SWFloat value;
+  std::memcpy(&value, &bits, sizeof(bits));
+  return value;
+}
+
+static uint32_t toBits(SWFloat value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  return bits;
+}
+
+struct PackedOperation {
+  const char *name;
+  SWFloat (*soft)(SWFloat, SWFloat);
+  void (*soft8)(const uint32_t[8], const uint32_t[8], uint32_t[8]);
+};
+
+std::ostream &operator<<(std::ostream &os, const PackedOperation &op) {
+  return os << op.name;
+}
+
+class SoftFloat8 : public Avx2Test,
+                   public ::testing::WithParamInterface<PackedOperation> {};
+
+// every lane has to match the scalar function, the lanes get different
+// combinations of the two inputs so that the per lane selects are exercised
+TEST_P(SoftFloat8, bit_identical_to_scalar) {
+  const PackedOperation op = GetParam();
+  EXPECT_TRUE(forAll(
+      [](std::mt19937 &rng) {
+        uint32_t a = rng();
+        uint32_t b = rng();
+        // close exponents, cancellation and rounding carries
+        if (rng() & 1) {
+          b = (b & 0x807FFFFFu) | (a & 0x7F800000u);
+        }
+        return FloatBits(a, b);
+      },
+      [](const FloatBits &o) { return shrinkTuple(o, shrinkFloatBits); },
+      [](const FloatBits &) { return true; }, [&op](const FloatBits &o) {
+        uint32_t a = std::get<0>(o);
+        uint32_t b = std::get<1>(o);
+        uint32_t lhs[8] = {a, b, a, a ^ 0x80000000u,
+                           a, b, a & 0x807FFFFFu, a};
+        uint32_t rhs[8] = {b, a, b ^ 0x80000000u, b, a, b, b, b & 0xFF800000u};
+        uint32_t result[8];
+        op.soft8(lhs, rhs, result);
+        for (int i = 0; i < 8; ++i) {
+          if (result[i] != toBits(op.soft(fromBits(lhs[i]), fromBits(rhs[i])))) {
+            return false;
+          }
+        }
+        return true;
+      },
+      50000));
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Operations, SoftFloat8,
+    ::testing::Values(PackedOperation{"addition", swFloatAddition,
+                                      avx2_kernels::swFloatAddition8},
+                      PackedOperation{"multiplication", swFloatMultiplication,
+                                      avx2_kernels::swFloatMultiplication8},
+                      PackedOperation{"division", swFloatDivision,
+                                      avx2_kernels::swFloatDivision8}),
+    [](const ::testing::TestParamInfo<PackedOperation> &info) {
+      return std::string(info.param.name);
+    });
+
+TEST(SWFloat, operators_match_functions) {
+  SWFloat a(3.75f);
+  SWFloat b(-1.125f);
+  EXPECT_EQ(toBits(a + b), toBits(swFloatAddition(a, b)));
+  EXPECT_EQ(toBits(a - b), toBits(swFloatAddition(a, SWFloat(1.125f))));
+  EXPECT_EQ(toBits(a * b), toBits(swFloatMultiplication(a, b)));
+  EXPECT_EQ(toBits(a / b), toBits(swFloatDivision(a, b)));
+  EXPECT_EQ(static_cast<float>(-b), 1.125f);
+  EXPECT_EQ(static_cast<float>(abs(b)), 1.125f);
+  EXPECT_TRUE(b < a);
+  EXPECT_TRUE(a == SWFloat(3.75f));
+
+  SWFloat c = a;
+  c += b;
+  c *= 2.0f;
+  c -= 1.0f;
+  c /= 4.0f;
+  EXPECT_EQ(static_cast<float>(c), ((3.75f - 1.125f) * 2.0f - 1.0f) / 4.0f);
+}
+
+class SWFloat8 : public Avx2Test {};
+
+TEST_F(SWFloat8, templated_code_matches_scalar_lanes) {
+  const float values[8] = {2.0f,  9.0f,    0.5f,  1234.5f,
+                           1e-3f, 7.25e5f, 42.0f, 3.0f};
+  float packed[8];
+  avx2_kernels::newtonSqrt8(values, 12, packed);
+  for (int i = 0; i < 8; ++i) {
+    SWFloat single = newtonSqrt(SWFloat(values[i]), 12);
+    EXPECT_EQ(packed[i], static_cast<float>(single)) << "lane " << i;
+    // converged and every step was a correctly rounded operation
+    EXPECT_EQ(packed[i], newtonSqrt(values[i], 12)) << "lane " << i;
+  }
+}
+
+TEST_F(SWFloat8, value_type_operations) {
+  const float values[8] = {1, -2, 3, -4, 5, -6, 7, -8};
+  float w[8];
+  avx2_kernels::valueTypeOperations8(values, w);
+  for (int i = 0; i < 8; ++i) {
+    float expected = ((-std::fabs(values[i]) + 1.0f) - values[i]) * 2.0f / 4.0f;
+    EXPECT_EQ(w[i], expected) << "lane " << i;
+  }
+}
+
+// the avx2 batch goes 8 at the time, a count that is not a multiple of 8
+// checks the scalar tail too
+TEST_F(SWFloat8, batch_tail_matches_single_calls) {
+  const size_t count = 8 * 5 + 3;
+  std::mt19937 rng(11);
+  std::vector<float> a(count), b(count), out(count);
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t abits = rng();
+    uint32_t bbits = rng();
+    std::memcpy(&a[i], &abits, sizeof(float));
+    std::memcpy(&b[i], &bbits, sizeof(float));
+  }
+  swFloatDivisionBatchAvx2(a.data(), b.data(), out.data(), count);
+  for (size_t i = 0; i < count; ++i) {
+    uint32_t bits;
+    std::memcpy(&bits, &out[i], sizeof(float));
+    ASSERT_EQ(bits, toBits(swFloatDivision(SWFloat(a[i]), SWFloat(b[i]))))
+        << "element " << i;
+  }
+}
+
+// the masks hold in the lanes where the SWFloat comparison is true, nans
+// included, and min, max and select pick the same bits as their scalar
+// versions
+TEST_F(SWFloat8, comparisons_match_scalar_lanes) {
+  EXPECT_TRUE(forAll(
+      [](std::mt19937 &rng) {
+        uint32_t a = rng();
+        uint32_t b = rng();
+        // equal values, zeros of both signs and nans show up often enough
+        switch (rng() % 4) {
+        case 0:
+          b = a;
+          break;
+        case 1:
+          b = a ^ 0x80000000u;
+          break;
+        case 2:
+          b = 0x7FC00000u | (b & 0x80000000u);
+          break;
+        }
+        return FloatBits(a, b);
+      },
+      [](const FloatBits &o) { return shrinkTuple(o, shrinkFloatBits); },
+      [](const FloatBits &) { return true; }, [](const FloatBits &o) {
+        uint32_t a = std::get<0>(o);
+        uint32_t b = std::get<1>(o);
+        uint32_t lhs[8] = {a, b, a, a ^ 0x80000000u, a, 0, 0x80000000u, a};
+        uint32_t rhs[8] = {b, a, a, b, 0x80000000u, 0, b, 0x7F800000u};
+        int masks[6];
+        uint32_t picked[3][8];
+        avx2_kernels::compare8(lhs, rhs, masks, picked);
+        for (int i = 0; i < 8; ++i) {
+          SWFloat l = fromBits(lhs[i]);
+          SWFloat r = fromBits(rhs[i]);
+          bool holds[6] = {l == r, l != r, l < r, l > r, l <= r, l >= r};
+          for (int c = 0; c < 6; ++c) {
+            if (((masks[c] >> i) & 1) != int(holds[c])) {
+              return false;
+            }
+          }
+          if (picked[0][i] != toBits(min(l, r)) ||
+              picked[1][i] != toBits(max(l, r)) ||
+              picked[2][i] != toBits(select(l < r, r, l))) {
+            return false;
+          }
+        }
+        return true;
+      },
+      20000));
+}
+
+TEST(SWFloat, min_and_max_answer_like_std) {
+  const float values[] = {1.5f, -2.0f, 0.0f, -0.0f, INFINITY, NAN};
+  for (float a : values) {
+    for (float b : values) {
+      EXPECT_EQ(toBits(min(SWFloat(a), SWFloat(b))),
+                toBits(SWFloat(std::min(a, b))))
+          << a << " " << b;
+      EXPECT_EQ(toBits(max(SWFloat(a), SWFloat(b))),
+                toBits(SWFloat(std::max(a, b))))
+          << a << " " << b;
+    }
+  }
+}
+
+TEST_F(SWFloat8, templated_loops_on_masks_match_scalar_lanes) {
+  const float values[8] = {-4.0f, 0.0f,    0.25f, 2.0f,
+                           9.0f,  1234.5f, 1e9f,  1e-9f};
+  const float lo = 1e-6f;
+  const float hi = 1e6f;
+  int packedSteps = 0;
+  float packed[8];
+  avx2_kernels::clampedSqrt8(values, lo, hi, packed, packedSteps);
+  int longest = 0;
+  for (int i = 0; i < 8; ++i) {
+    int steps = 0;
+    SWFloat single =
+        clampedSqrt(SWFloat(values[i]), SWFloat(lo), SWFloat(hi), steps);
+    longest = std::max(longest, steps);
+    EXPECT_EQ(packed[i], static_cast<float>(single)) << "lane " << i;
+    float clamped = std::min(std::max(values[i], lo), hi);
+    EXPECT_NEAR(packed[i], std::sqrt(clamped), 1e-6f * std::sqrt(clamped))
+        << "lane " << i;
+  }
+  // the 8 wide loop runs until its slowest lane is done
+  EXPECT_EQ(packedSteps, longest);
+  EXPECT_LT(packedSteps, 100);
+}
@@ -1,22 +1,8 @@
 #include <gmock/gmock.h>
 
-class myClass
-{
-public:
-	myClass(int value):m_value(value){};
-	int m_value;
-};
-
-
-TEST(myClass, constructor_test)
-{
-	myClass c(10);
-	EXPECT_EQ(c.m_value, 10 );
+// entry point of the suite, the tests live in the *Test.cpp files next to
+// this one, one per kernel header
+int main(int argc, char **argv) {
+  ::testing::InitGoogleMock(&argc, argv);
+  return RUN_ALL_TESTS();
 }
-
-
-TEST(myClass, constructor_test2)
-{
-	myClass c(15);
-	EXPECT_EQ(c.m_value, 15 );
-}
\ No newline at end of file
@@ -0,0 +1,165 @@
+#include "../branchless/uv.h"
+#include "../branchless/uvMesh.h"
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+
+struct TestMesh {
+  std::vector<uint32_t> indices;
+  std::vector<float> uvs;
+};
+
+// grid of side x side vertices, two triangles per cell, triangles and
+// vertices shuffled like a mesh coming out of a dcc tool
+static TestMesh shuffledGrid(uint32_t side, uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::vector<uint32_t> vertexOrder(side * side);
+  std::iota(vertexOrder.begin(), vertexOrder.end(), 0u);
+  std::shuffle(vertexOrder.begin(), vertexOrder.end(), rng);
+
+  TestMesh mesh;
+  mesh.uvs.resize(2 * side * side);
+  for (uint32_t y = 0; y < side; ++y) {
+    for (uint32_t x = 0; x < side; ++x) {
+      uint32_t v = vertexOrder[y * side + x];
+      mesh.uvs[2 * v] = 0.5f * x / side;
+      mesh.uvs[2 * v + 1] = 0.5f * y / side;
+    }
+  }
+  std::vector<uint32_t> cells((side - 1) * (side - 1));
+  std::iota(cells.begin(), cells.end(), 0u);
+  std::shuffle(cells.begin(), cells.end(), rng);
+  for (uint32_t cell : cells) {
+    uint32_t x = cell % (side - 1);
+    uint32_t y = cell / (side - 1);
+    uint32_t a = vertexOrder[y * side + x];
+    uint32_t b = vertexOrder[y * side + x + 1];
+    uint32_t c = vertexOrder[(y + 1) * side + x];
+    uint32_t d = vertexOrder[(y + 1) * side + x + 1];
+    mesh.indices.insert(mesh.indices.end(), {a, b, c, b, d, c});
+  }
+  return mesh;
+}
+
+// what offsetMeshUVs has to produce, one corner at the time
+static std::vector<float> referenceOffsets(const TestMesh &mesh) {
+  std::vector<float> out(2 * mesh.indices.size());
+  for (size_t corner = 0; corner < mesh.indices.size(); ++corner) {
+    offsetUVsNoBranch3(&mesh.uvs[2 * mesh.indices[corner]], &out[2 * corner]);
+  }
+  return out;
+}
+
+TEST(UVMesh, memory_and_morton_visits_match_single_corners) {
+  TestMesh mesh = shuffledGrid(37, 1);
+  const size_t triangles = mesh.indices.size() / 3;
+  const size_t vertices = mesh.uvs.size() / 2;
+  std::vector<float> expected = referenceOffsets(mesh);
+
+  std::vector<float> out(expected.size());
+  offsetMeshUVs(mesh.indices.data(), triangles, mesh.uvs.data(), vertices,
+                nullptr, out.data());
+  EXPECT_EQ(out, expected);
+
+  std::vector<uint32_t> order(triangles);
+  mortonTriangleOrder(mesh.indices.data(), triangles, mesh.uvs.data(),
+                      order.data());
+  std::vector<uint32_t> sorted = order;
+  std::sort(sorted.begin(), sorted.end());
+  for (uint32_t t = 0; t < triangles; ++t) {
+    ASSERT_EQ(sorted[t], t);
+  }
+  // the output follows the visit
+  offsetMeshUVs(mesh.indices.data(), triangles, mesh.uvs.data(), vertices,
+                order.data(), out.data());
+  for (size_t k = 0; k < triangles; ++k) {
+    for (int i = 0; i < 6; ++i) {
+      ASSERT_EQ(out[6 * k + i], expected[6 * order[k] + i]) << k;
+    }
+  }
+}
+
+TEST(UVMesh, reordered_mesh_keeps_every_triangle_and_fetches_in_order) {
+  TestMesh mesh = shuffledGrid(20, 2);
+  const size_t triangles = mesh.indices.size() / 3;
+  const size_t vertices = mesh.uvs.size() / 2;
+  // one unused vertex, it has to end up last
+  mesh.uvs.push_back(0.25f);
+  mesh.uvs.push_back(0.125f);
+
+  std::vector<uint32_t> order(triangles);
+  mortonTriangleOrder(mesh.indices.data(), triangles, mesh.uvs.data(),
+                      order.data());
+  TestMesh reordered;
+  reordered.indices.resize(mesh.indices.size());
+  reordered.uvs.resize(mesh.uvs.size());
+  reorderUVMesh(mesh.indices.data(), triangles, mesh.uvs.data(), vertices + 1,
+                order.data(), reordered.indices.data(), reordered.uvs.data());
+
+  uint32_t highest = 0;
+  for (size_t k = 0; k < triangles; ++k) {
+    for (int c = 0; c < 3; ++c) {
+      uint32_t before = mesh.indices[3 * order[k] + c];
+      uint32_t after = reordered.indices[3 * k + c];
+      EXPECT_EQ(reordered.uvs[2 * after], mesh.uvs[2 * before]);
+      EXPECT_EQ(reordered.uvs[2 * after + 1], mesh.uvs[2 * before + 1]);
+      // first use order, a new vertex is always the next one
+      EXPECT_LE(after, highest);
+      highest = std::max(highest, after + 1);
+    }
+  }
+  EXPECT_EQ(reordered.uvs[2 * vertices], 0.25f);
+  EXPECT_EQ(reordered.uvs[2 * vertices + 1], 0.125f);
+}
+
+// per mesh offset, float and double, against one corner at the time
+template <typename T> static void checkMeshOffset(T offset) {
+  TestMesh mesh = shuffledGrid(23, 3);
+  const size_t triangles = mesh.indices.size() / 3;
+  const size_t vertices = mesh.uvs.size() / 2;
+  // above 1 after the offset on part of the grid, the wrap gets exercised
+  std::vector<T> uvs(mesh.uvs.begin(), mesh.uvs.end());
+  for (T &value : uvs) {
+    value *= T(1.5);
+  }
+  std::vector<T> expected(2 * mesh.indices.size());
+  for (size_t corner = 0; corner < mesh.indices.size(); ++corner) {
+    offsetUVsNoBranch(&uvs[2 * mesh.indices[corner]], &expected[2 * corner],
+                      UVOffsets<T>(offset));
+  }
+
+  std::vector<T> out(expected.size());
+  offsetMeshUVs(mesh.indices.data(), triangles, uvs.data(), vertices, nullptr,
+                out.data(), offset);
+  EXPECT_EQ(out, expected);
+
+  std::vector<uint32_t> order(triangles);
+  std::iota(order.rbegin(), order.rend(), 0u);
+  offsetMeshUVs(mesh.indices.data(), triangles, uvs.data(), vertices,
+                order.data(), out.data(), offset);
+  for (size_t k = 0; k < triangles; ++k) {
+    for (int i = 0; i < 6; ++i) {
+      ASSERT_EQ(out[6 * k + i], expected[6 * order[k] + i]) << k;
+    }
+  }
+
+  // caller owned scratch, reused from a previous call with garbage in it
+  std::vector<T> scratch(2 * vertices, T(-7));
+  for (int call = 0; call < 2; ++call) {
+    std::fill(out.begin(), out.end(), T(0));
+    offsetMeshUVs(mesh.indices.data(), triangles, uvs.data(), vertices, nullptr,
+                  out.data(), offset, scratch.data());
+    EXPECT_EQ(out, expected);
+  }
+}
+
+TEST(UVMesh, per_mesh_offset_matches_single_corners) {
+  checkMeshOffset<float>(0.3f);
+  checkMeshOffset<float>(0.75f);
+  checkMeshOffset<double>(0.3);
+  checkMeshOffset<double>(0.125);
+}
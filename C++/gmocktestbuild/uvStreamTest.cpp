@@ -0,0 +1,117 @@
+#include "../branchless/uvBatch.h"
+#include "../branchless/uvStream.h"
+
+#include <gmock/gmock.h>
+
+#include <cstdio>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+// temporary file removed at the end of the test
+struct TempFile {
+  std::string path;
+  TempFile() {
+    char name[] = "/tmp/uvStreamTestXXXXXX";
+    int fd = mkstemp(name);
+    close(fd);
+    path = name;
+  }
+  ~TempFile() { std::remove(path.c_str()); }
+};
+
+static void writeFile(const std::string &path, const void *data,
+                      size_t bytes) {
+  FILE *file = std::fopen(path.c_str(), "wb");
+  std::fwrite(data, 1, bytes, file);
+  std::fclose(file);
+}
+
+static std::vector<float> readFloats(const std::string &path) {
+  std::vector<float> data;
+  FILE *file = std::fopen(path.c_str(), "rb");
+  float value;
+  while (std::fread(&value, sizeof(value), 1, file) == 1) {
+    data.push_back(value);
+  }
+  std::fclose(file);
+  return data;
+}
+
+TEST(UVStream, matches_the_batch_kernel_across_chunks) {
+  // several chunks with a partial one at the end
+  const size_t pairs = 100003;
+  std::mt19937 rng(5);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  std::vector<float> uvs(2 * pairs);
+  for (float &value : uvs) {
+    value = unit(rng);
+  }
+  TempFile input;
+  TempFile output;
+  writeFile(input.path, uvs.data(), uvs.size() * sizeof(float));
+
+  UVStreamOptions options;
+  options.chunkBytes = 64 << 10;
+  options.prefetchChunks = 2;
+  options.offset = 1.0f / 256.0f;
+  UVStreamStats stats;
+  std::string error;
+  ASSERT_TRUE(offsetUVFile(input.path.c_str(), output.path.c_str(), options,
+                           &stats, &error))
+      << error;
+  EXPECT_EQ(stats.pairs, pairs);
+  EXPECT_EQ(stats.chunks, (uvs.size() * sizeof(float) + (64 << 10) - 1) /
+                              (64 << 10));
+
+  std::vector<float> expected(uvs.size());
+  offsetUVsBatch(uvs.data(), expected.data(), pairs, options.offset);
+  EXPECT_EQ(readFloats(output.path), expected);
+}
+
+TEST(UVStream, empty_input_gives_empty_output) {
+  TempFile input;
+  TempFile output;
+  UVStreamStats stats;
+  std::string error;
+  ASSERT_TRUE(offsetUVFile(input.path.c_str(), output.path.c_str(),
+                           UVStreamOptions(), &stats, &error))
+      << error;
+  EXPECT_EQ(stats.pairs, 0u);
+  EXPECT_TRUE(readFloats(output.path).empty());
+}
+
+TEST(UVStream, reports_bad_inputs) {
+  TempFile input;
+  TempFile output;
+  std::string error;
+  EXPECT_FALSE(offsetUVFile("/nonexistent/uvs.bin", output.path.c_str(),
+                            UVStreamOptions(), nullptr, &error));
+  EXPECT_THAT(error, ::testing::HasSubstr("/nonexistent/uvs.bin"));
+
+  // half a pair
+  float single = 0.5f;
+  writeFile(input.path, &single, sizeof(single));
+  EXPECT_FALSE(offsetUVFile(input.path.c_str(), output.path.c_str(),
+                            UVStreamOptions(), nullptr, &error));
+  EXPECT_THAT(error, ::testing::HasSubstr("pairs"));
+}
+
+TEST(UVStream, refuses_to_write_over_its_input) {
+  const float uvs[4] = {0.25f, 0.5f, 0.75f, 1.0f};
+  TempFile input;
+  writeFile(input.path, uvs, sizeof(uvs));
+  std::string error;
+  EXPECT_FALSE(offsetUVFile(input.path.c_str(), input.path.c_str(),
+                            UVStreamOptions(), nullptr, &error));
+  EXPECT_THAT(error, ::testing::HasSubstr("the output is the input"));
+
+  // another name for the same file
+  TempFile link;
+  std::remove(link.path.c_str());
+  ASSERT_EQ(::link(input.path.c_str(), link.path.c_str()), 0);
+  EXPECT_FALSE(offsetUVFile(input.path.c_str(), link.path.c_str(),
+                            UVStreamOptions(), nullptr, &error));
+  EXPECT_EQ(readFloats(input.path), std::vector<float>(uvs, uvs + 4));
+}
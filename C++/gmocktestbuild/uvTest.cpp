@@ -0,0 +1,138 @@
+#include "avx2Test.h"
+#include "propertyTesting.h"
+
+#include "../branchless/uv.h"
+
+#include <gmock/gmock.h>
+
+using property_testing::forAll;
+
+typedef void (*UVKernel)(const float[2], float[2]);
+
+struct UVVariant {
+  const char *name;
+  UVKernel kernel;
+  bool avx2 = false;
+};
+
+std::ostream &operator<<(std::ostream &os, const UVVariant &v) {
+  return os << v.name;
+}
+
+class UVOffset : public ::testing::TestWithParam<UVVariant> {
+protected:
+  void SetUp() override {
+    if (GetParam().avx2 && !dispatch::isaSupported(dispatch::Isa::Avx2)) {
+      GTEST_SKIP() << "cpu does not support avx2";
+    }
+  }
+};
+
+typedef std::tuple<uint32_t, uint32_t> GridUV;
+
+// uv on a 1/1024 grid inside the triangle, the values are exact in float so
+// 1 - u - v and 1 - (u + v) agree and all the variants see the same ordering
+static const float GRID = 1024.0f;
+
+TEST_P(UVOffset, matches_branchy_reference) {
+  UVKernel kernel = GetParam().kernel;
+  EXPECT_TRUE(forAll(
+      [](std::mt19937 &rng) {
+        uint32_t u = rng() % 1025;
+        uint32_t v = rng() % (1025 - u);
+        return GridUV(u, v);
+      },
+      [](const GridUV &o) {
+        return property_testing::shrinkTuple(
+            o, property_testing::shrinkUnsigned);
+      },
+      [](const GridUV &o) { return std::get<0>(o) + std::get<1>(o) <= 1024; },
+      [kernel](const GridUV &o) {
+        float uv[2] = {float(std::get<0>(o)) / GRID,
+                       float(std::get<1>(o)) / GRID};
+        float expected[2];
+        float result[2] = {-1.0f, -1.0f};
+        offsetUVs(uv, expected);
+        kernel(uv, result);
+        return expected[0] == result[0] && expected[1] == result[1];
+      }));
+}
+
+TEST_P(UVOffset, moves_toward_the_center) {
+  UVKernel kernel = GetParam().kernel;
+  // closest to the u = 0 edge
+  float uv[2] = {0.125f, 0.5f};
+  float result[2];
+  kernel(uv, result);
+  EXPECT_FLOAT_EQ(result[0], 0.125f + UV_OFFSET);
+  EXPECT_FLOAT_EQ(result[1], 0.5f - UV_OFFSET_HALF);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Variants, UVOffset,
+    ::testing::Values(UVVariant{"branchy", offsetUVs},
+                      UVVariant{"noBranch1", avx2_kernels::offsetUVsNoBranch1,
+                                true},
+                      UVVariant{"noBranch2", avx2_kernels::offsetUVsNoBranch2,
+                                true},
+                      UVVariant{"noBranch3", offsetUVsNoBranch3},
+                      UVVariant{"generic",
+                                [](const float uv[2], float out[2]) {
+                                  offsetUVsNoBranch(uv, out,
+                                                    UVOffsets<float>());
+                                }}),
+    [](const ::testing::TestParamInfo<UVVariant> &info) {
+      return std::string(info.param.name);
+    });
+
+class UVOffsetsAvx2 : public Avx2Test {};
+
+TEST_F(UVOffsetsAvx2, per_call_offsets_agree_across_kernels) {
+  // texel sized, 1/512
+  const UVOffsets<float> offsets(1.0f / 512.0f);
+  const float uvs[][2] = {{0.125f, 0.5f}, {0.5f, 0.125f}, {0.5f, 0.375f},
+                          {0.25f, 0.25f}};
+  for (const auto &uv : uvs) {
+    float generic[2];
+    float noBranch1[2];
+    float noBranch2[2];
+    offsetUVsNoBranch(uv, generic, offsets);
+    avx2_kernels::offsetUVsNoBranch1(uv, noBranch1, offsets.offset);
+    avx2_kernels::offsetUVsNoBranch2(uv, noBranch2, offsets.offset);
+    EXPECT_EQ(generic[0], noBranch1[0]);
+    EXPECT_EQ(generic[1], noBranch1[1]);
+    EXPECT_EQ(generic[0], noBranch2[0]);
+    EXPECT_EQ(generic[1], noBranch2[1]);
+  }
+  float moved[2];
+  offsetUVsNoBranch(uvs[0], moved, offsets);
+  EXPECT_EQ(moved[0], 0.125f + 1.0f / 512.0f);
+  EXPECT_EQ(moved[1], 0.5f - 1.0f / 1024.0f);
+}
+
+TEST(UVOffsets, double_path_keeps_precision) {
+  // below the float ulp of the coordinates, float would not move them at all
+  const UVOffsets<double> offsets(1e-9);
+  const double uv[2] = {0.125, 0.5};
+  double moved[2];
+  offsetUVsNoBranch(uv, moved, offsets);
+  EXPECT_EQ(moved[0], 0.125 + 1e-9);
+  EXPECT_EQ(moved[1], 0.5 - 0.5e-9);
+  EXPECT_EQ(0.125f + 1e-9f, 0.125f);
+}
+
+class Compress256 : public Avx2Test {};
+
+TEST_F(Compress256, packs_selected_lanes_to_the_left) {
+  const float values[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+  float out[8];
+  for (unsigned int mask = 0; mask < 256; ++mask) {
+    avx2_kernels::compress256(values, mask, out);
+    int slot = 0;
+    for (int lane = 0; lane < 8; ++lane) {
+      if (mask & (1u << lane)) {
+        ASSERT_EQ(out[slot++], float(lane)) << "mask " << mask;
+      }
+    }
+  }
+}
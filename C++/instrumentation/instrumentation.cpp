@@ -0,0 +1,285 @@
+#include "instrumentation.h"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace instrumentation {
+
+const char *counterName(Counter counter) {
+  switch (counter) {
+  case Counter::SoftFloatCalls:
+    return "softFloatCalls";
+  case Counter::SoftFloatDenormals:
+    return "softFloatDenormals";
+  case Counter::SoftFloatRounding:
+    return "softFloatRounding";
+  case Counter::KaratsubaCalls:
+    return "karatsubaCalls";
+  case Counter::KaratsubaDepth:
+    return "karatsubaDepth";
+  case Counter::UVOffsetPairs:
+    return "uvOffsetPairs";
+  case Counter::Compress256Calls:
+    return "compress256Calls";
+  default:
+    return "unknown";
+  }
+}
+
+#if defined(KERNELS_INSTRUMENT)
+
+namespace {
+
+struct TraceEvent {
+  const char *name;
+  uint64_t begin;
+  uint64_t end;
+};
+
+// the events of a thread, kept after the thread exits so that short lived
+// workers still show up in the export. The owner fills events[size] and then
+// publishes the new size, the exporter never reads past it
+struct ThreadTrace {
+  explicit ThreadTrace(uint32_t id) : id(id), events(TRACE_EVENTS_PER_THREAD) {}
+  uint32_t id;
+  std::vector<TraceEvent> events;
+  std::atomic<size_t> size{0};
+  std::atomic<size_t> dropped{0};
+};
+
+struct Registry {
+  std::mutex mutex;
+  std::vector<ThreadCounters *> live;
+  uint64_t retired[COUNTER_COUNT] = {};
+  std::vector<std::unique_ptr<ThreadTrace>> traces;
+  // time stamp counter and clock read together, the export reads them again
+  // to turn ticks into microseconds
+  uint64_t originTicks = readTimeStamp();
+  std::chrono::steady_clock::time_point originTime =
+      std::chrono::steady_clock::now();
+};
+
+Registry &registry() {
+  // never destroyed, threads can still exit after main returns
+  static Registry *instance = new Registry();
+  return *instance;
+}
+
+// created at startup so that the origin comes before any event
+Registry &startupRegistry = registry();
+
+double sinceOrigin(uint64_t ticks, double tickScale) {
+  uint64_t origin = registry().originTicks;
+  return ticks > origin ? double(ticks - origin) * tickScale : 0.0;
+}
+
+void mergeInto(uint64_t *totals, ThreadCounters &counters) {
+  for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+    uint64_t value = std::atomic_ref<uint64_t>(counters.values[i])
+                         .load(std::memory_order_relaxed);
+    if (isMaxCounter(static_cast<Counter>(i))) {
+      totals[i] = value > totals[i] ? value : totals[i];
+    } else {
+      totals[i] += value;
+    }
+  }
+}
+
+// folds the counters in the retired totals when the thread exits
+struct ThreadRetirer {
+  ThreadCounters *counters = nullptr;
+  ~ThreadRetirer() {
+    if (counters == nullptr) {
+      return;
+    }
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    mergeInto(reg.retired, *counters);
+    for (size_t i = 0; i < reg.live.size(); ++i) {
+      if (reg.live[i] == counters) {
+        reg.live[i] = reg.live.back();
+        reg.live.pop_back();
+        break;
+      }
+    }
+    // whatever runs later on this thread is not counted anymore
+    counters->state = 2;
+  }
+};
+
+thread_local ThreadRetirer threadRetirer;
+thread_local ThreadTrace *threadTrace = nullptr;
+
+ThreadTrace &localTrace() {
+  if (threadTrace == nullptr) {
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.traces.push_back(std::make_unique<ThreadTrace>(
+        static_cast<uint32_t>(reg.traces.size())));
+    threadTrace = reg.traces.back().get();
+  }
+  return *threadTrace;
+}
+
+double ticksPerMicrosecond() {
+  Registry &reg = registry();
+  // not enough time passed for a good estimate, waiting a bit
+  auto elapsed = std::chrono::steady_clock::now() - reg.originTime;
+  if (elapsed < std::chrono::milliseconds(10)) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10) - elapsed);
+  }
+  uint64_t ticks = readTimeStamp();
+  double micros = std::chrono::duration<double, std::micro>(
+                      std::chrono::steady_clock::now() - reg.originTime)
+                      .count();
+  return double(ticks - reg.originTicks) / micros;
+}
+
+} // namespace
+
+void registerThread(ThreadCounters &counters) {
+  if (counters.state != 0) {
+    return;
+  }
+  Registry &reg = registry();
+  {
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    reg.live.push_back(&counters);
+  }
+  threadRetirer.counters = &counters;
+  counters.state = 1;
+}
+
+CounterSnapshot snapshotCounters() {
+  registerThisThread();
+  Registry &reg = registry();
+  CounterSnapshot snapshot;
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+    snapshot.values[i] = reg.retired[i];
+  }
+  for (ThreadCounters *counters : reg.live) {
+    mergeInto(snapshot.values, *counters);
+  }
+  return snapshot;
+}
+
+void recordTrace(const char *name, uint64_t begin, uint64_t end) {
+  ThreadTrace &trace = localTrace();
+  size_t size = trace.size.load(std::memory_order_relaxed);
+  if (size == trace.events.size()) {
+    trace.dropped.store(trace.dropped.load(std::memory_order_relaxed) + 1,
+                        std::memory_order_relaxed);
+    return;
+  }
+  trace.events[size] = TraceEvent{name, begin, end};
+  trace.size.store(size + 1, std::memory_order_release);
+}
+
+size_t traceEventCount() {
+  Registry &reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  size_t count = 0;
+  for (const auto &trace : reg.traces) {
+    count += trace->size.load(std::memory_order_acquire);
+  }
+  return count;
+}
+
+size_t droppedTraceEvents() {
+  Registry &reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  size_t count = 0;
+  for (const auto &trace : reg.traces) {
+    count += trace->dropped.load(std::memory_order_relaxed);
+  }
+  return count;
+}
+
+void clearTrace() {
+  Registry &reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  for (const auto &trace : reg.traces) {
+    trace->size.store(0, std::memory_order_relaxed);
+    trace->dropped.store(0, std::memory_order_relaxed);
+  }
+}
+
+// names are c identifiers in practice, quotes and backslashes are escaped
+// anyway so that a weird one does not break the file
+static void writeJsonString(FILE *out, const char *text) {
+  std::fputc('"', out);
+  for (const char *c = text; *c; ++c) {
+    if (*c == '"' || *c == '\\') {
+      std::fputc('\\', out);
+    }
+    std::fputc(*c, out);
+  }
+  std::fputc('"', out);
+}
+
+bool writeChromeTrace(FILE *out) {
+  const double tickScale = 1.0 / ticksPerMicrosecond();
+  CounterSnapshot counters = snapshotCounters();
+  Registry &reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+
+  std::fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+  const char *separator = "";
+  uint64_t last = reg.originTicks;
+  for (const auto &trace : reg.traces) {
+    size_t size = trace->size.load(std::memory_order_acquire);
+    for (size_t i = 0; i < size; ++i) {
+      const TraceEvent &event = trace->events[i];
+      std::fprintf(out, "%s{\"name\":", separator);
+      writeJsonString(out, event.name);
+      std::fprintf(out,
+                   ",\"cat\":\"kernels\",\"ph\":\"X\",\"ts\":%.3f,"
+                   "\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                   sinceOrigin(event.begin, tickScale),
+                   double(event.end - event.begin) * tickScale, trace->id);
+      last = event.end > last ? event.end : last;
+      separator = ",\n";
+    }
+  }
+  // the counters totals at the end of the timeline
+  std::fprintf(out, "%s{\"name\":\"counters\",\"ph\":\"C\",\"ts\":%.3f,"
+               "\"pid\":1,\"args\":{",
+               separator, sinceOrigin(last, tickScale));
+  for (size_t i = 0; i < COUNTER_COUNT; ++i) {
+    std::fprintf(out, "%s\"%s\":%llu", i ? "," : "",
+                 counterName(static_cast<Counter>(i)),
+                 static_cast<unsigned long long>(counters.values[i]));
+  }
+  std::fprintf(out, "}}\n]}\n");
+  return std::ferror(out) == 0;
+}
+
+#else
+
+CounterSnapshot snapshotCounters() { return CounterSnapshot(); }
+size_t traceEventCount() { return 0; }
+size_t droppedTraceEvents() { return 0; }
+void clearTrace() {}
+
+bool writeChromeTrace(FILE *out) {
+  std::fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[]}\n");
+  return std::ferror(out) == 0;
+}
+
+#endif
+
+bool writeChromeTrace(const std::string &path) {
+  FILE *out = std::fopen(path.c_str(), "w");
+  if (out == nullptr) {
+    return false;
+  }
+  bool written = writeChromeTrace(out);
+  return (std::fclose(out) == 0) && written;
+}
+
+} // namespace instrumentation
@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#if defined(KERNELS_INSTRUMENT)
+#include <atomic>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+// Counters and timers for the hot kernels, compiled in only when the build
+// defines KERNELS_INSTRUMENT (cmake -DKERNELS_INSTRUMENT=ON). Without it the
+// KERNELS_* macros expand to nothing, the arguments are not even evaluated,
+// so the kernels are the exact same code as before.
+//
+// Counters are per thread, every thread owns a cache line padded block that
+// only it writes, no locked instruction on the hot path, snapshotCounters()
+// sums the blocks of the registered threads and what the finished ones left.
+// Trace scopes read the time stamp counter on entry and exit and append a
+// complete event to a per thread buffer, they are meant for batch sized work
+// (a dispatcher call, a mesh, a chunk), not for a single pair of floats.
+// writeChromeTrace() dumps everything in the chrome://tracing / perfetto
+// json format.
+
+namespace instrumentation {
+
+enum class Counter : uint32_t {
+  SoftFloatCalls,     // swFloat* single ops, the batches go through them too
+  SoftFloatDenormals, // results flushed to zero, there are no denormals
+  SoftFloatRounding,  // inexact results, grs bits set before rounding
+  KaratsubaCalls,     // karatsuba() calls and multi limb levels
+  KaratsubaDepth,     // deepest recursion seen, a max not a sum
+  UVOffsetPairs,      // uv pairs through offsetUVs* and the batches
+  Compress256Calls,
+  COUNT
+};
+
+static const size_t COUNTER_COUNT = static_cast<size_t>(Counter::COUNT);
+
+const char *counterName(Counter counter);
+// depth counters merge with max, the other ones add up
+constexpr bool isMaxCounter(Counter counter) {
+  return counter == Counter::KaratsubaDepth;
+}
+
+struct CounterSnapshot {
+  uint64_t values[COUNTER_COUNT] = {};
+  uint64_t operator[](Counter counter) const {
+    return values[static_cast<size_t>(counter)];
+  }
+};
+
+// all threads, taken while they run is fine, every value is a bit behind
+CounterSnapshot snapshotCounters();
+
+// events recorded so far and the ones that did not fit in the per thread
+// buffers (TRACE_EVENTS_PER_THREAD each)
+static const size_t TRACE_EVENTS_PER_THREAD = 1 << 16;
+size_t traceEventCount();
+size_t droppedTraceEvents();
+// forgets the recorded events, only while no trace scope is open
+void clearTrace();
+
+// chrome trace json, the counters are appended as a counter event, returns
+// false on io errors. Empty trace when the instrumentation is compiled out
+bool writeChromeTrace(FILE *out);
+bool writeChromeTrace(const std::string &path);
+
+constexpr bool enabled() {
+#if defined(KERNELS_INSTRUMENT)
+  return true;
+#else
+  return false;
+#endif
+}
+
+#if defined(KERNELS_INSTRUMENT)
+
+// one per thread, only the owner writes it. Other threads read it while it
+// runs, so every access is atomic: the owner does a relaxed load and a relaxed
+// store, no read modify write since nobody else writes, an atomic increment
+// per call (lock add) made offsetUVsNoBranch3 five times slower. The load and
+// store still cost the loops of the single pair kernels their vectorization,
+// offsetUVsNoBranch3 goes from 1.5 to about 5ns per pair in an instrumented
+// build. The readers do relaxed loads, a value can be a bit behind
+struct alignas(64) ThreadCounters {
+  uint64_t values[COUNTER_COUNT] = {};
+  // current recursion depth per counter, only the owner looks at it
+  alignas(64) uint32_t depth[COUNTER_COUNT] = {};
+  // 0 not registered yet, 1 registered, 2 thread exiting
+  uint32_t state = 0;
+};
+static_assert(alignof(uint64_t) >=
+                  std::atomic_ref<uint64_t>::required_alignment,
+              "the counters are accessed through atomic_ref");
+
+// constant initialized, accessing it is a plain fs relative address, no
+// thread local init guard
+inline thread_local ThreadCounters threadCounters;
+
+void registerThread(ThreadCounters &counters);
+
+// makes the counters of the calling thread visible to snapshotCounters(),
+// what was counted before is not lost, the block is the same. Trace and
+// depth scopes and snapshotCounters() do it on their own, the counting
+// itself does not: even a never taken call in the branch was enough to stop
+// the vectorization of a loop of offsetUVsNoBranch3. A thread that only runs
+// the single pair kernels has to call this once (the job workers do)
+inline void registerThisThread() {
+  if (threadCounters.state == 0) {
+    registerThread(threadCounters);
+  }
+}
+
+inline void add(Counter counter, uint64_t amount) {
+  std::atomic_ref<uint64_t> value(
+      threadCounters.values[static_cast<size_t>(counter)]);
+  value.store(value.load(std::memory_order_relaxed) + amount,
+              std::memory_order_relaxed);
+}
+
+inline void raise(Counter counter, uint64_t value) {
+  std::atomic_ref<uint64_t> current(
+      threadCounters.values[static_cast<size_t>(counter)]);
+  uint64_t old = current.load(std::memory_order_relaxed);
+  current.store(value > old ? value : old, std::memory_order_relaxed);
+}
+
+// keeps track of the recursion depth while alive, the max goes in the counter
+class DepthScope {
+public:
+  explicit DepthScope(Counter counter)
+      : m_counters(threadCounters), m_index(static_cast<size_t>(counter)) {
+    registerThisThread();
+    raise(counter, ++m_counters.depth[m_index]);
+  }
+  ~DepthScope() { --m_counters.depth[m_index]; }
+  DepthScope(const DepthScope &) = delete;
+  DepthScope &operator=(const DepthScope &) = delete;
+
+private:
+  ThreadCounters &m_counters;
+  size_t m_index;
+};
+
+inline uint64_t readTimeStamp() { return __rdtsc(); }
+
+// name must outlive the export, string literals are what the macro takes
+void recordTrace(const char *name, uint64_t begin, uint64_t end);
+
+class TraceScope {
+public:
+  explicit TraceScope(const char *name)
+      : m_name(name), m_begin(readTimeStamp()) {
+    registerThisThread();
+  }
+  ~TraceScope() { recordTrace(m_name, m_begin, readTimeStamp()); }
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+  const char *m_name;
+  uint64_t m_begin;
+};
+
+#define KERNELS_INSTRUMENT_CONCAT_IMPL(a, b) a##b
+#define KERNELS_INSTRUMENT_CONCAT(a, b) KERNELS_INSTRUMENT_CONCAT_IMPL(a, b)
+
+#define KERNELS_COUNT(counter)                                                 \
+  ::instrumentation::add(::instrumentation::Counter::counter, 1)
+#define KERNELS_COUNT_N(counter, amount)                                       \
+  ::instrumentation::add(::instrumentation::Counter::counter,                  \
+                         static_cast<uint64_t>(amount))
+#define KERNELS_COUNT_MAX(counter, value)                                      \
+  ::instrumentation::raise(::instrumentation::Counter::counter,                \
+                           static_cast<uint64_t>(value))
+#define KERNELS_DEPTH_SCOPE(counter)                                           \
+  ::instrumentation::DepthScope KERNELS_INSTRUMENT_CONCAT(                     \
+      kernelsDepthScope, __LINE__)(::instrumentation::Counter::counter)
+#define KERNELS_TRACE_SCOPE(name)                                              \
+  ::instrumentation::TraceScope KERNELS_INSTRUMENT_CONCAT(kernelsTraceScope,   \
+                                                          __LINE__)(name)
+
+#else
+
+inline void registerThisThread() {}
+
+#define KERNELS_COUNT(counter) ((void)0)
+#define KERNELS_COUNT_N(counter, amount) ((void)0)
+#define KERNELS_COUNT_MAX(counter, value) ((void)0)
+#define KERNELS_DEPTH_SCOPE(counter) ((void)0)
+#define KERNELS_TRACE_SCOPE(name) ((void)0)
+
+#endif
+
+} // namespace instrumentation
@@ -1,5 +1,9 @@
+#pragma once
+
 #include <cstdint>
 
+#include "../instrumentation/instrumentation.h"
+
 namespace cpp_tools {
 namespace algorithms {
 
@@ -12,7 +16,7 @@ inline uint32_t findHighestBit(uint32_t v) {
   return r;
 }
 
-uint32_t simpleMultSlow(uint32_t a, uint32_t b) {
+inline uint32_t simpleMultSlow(uint32_t a, uint32_t b) {
 
   uint32_t result = 0;
   for (uint32_t bi = 0; bi <= 31; ++bi) {
@@ -32,7 +36,7 @@ uint32_t simpleMultSlow(uint32_t a, uint32_t b) {
   return result;
 }
 
-uint32_t simpleMultFaster(uint32_t a, uint32_t b) {
+inline uint32_t simpleMultFaster(uint32_t a, uint32_t b) {
 
   uint32_t abit = findHighestBit(a);
   uint32_t bbit = findHighestBit(b);
@@ -51,7 +55,7 @@ uint32_t simpleMultFaster(uint32_t a, uint32_t b) {
   return result;
 }
 
-uint32_t karatsubaOneLevel(uint32_t x, uint32_t y, uint32_t size) {
+inline uint32_t karatsubaOneLevel(uint32_t x, uint32_t y, uint32_t size) {
   // generating mask
   int halfSize = size >> 1;
 
@@ -73,7 +77,7 @@ uint32_t karatsubaOneLevel(uint32_t x, uint32_t y, uint32_t size) {
   return (2 << size) * step1 + (2 << halfSize) * gauss + step2;
 }
 
-uint32_t karatsuba(uint32_t x, uint32_t y, uint32_t size) {
+inline uint32_t karatsubaRecursive(uint32_t x, uint32_t y, uint32_t size) {
 
   if (size <= 4) {
     return simpleMultFaster(x, y);
@@ -91,11 +95,27 @@ uint32_t karatsuba(uint32_t x, uint32_t y, uint32_t size) {
   uint32_t d = y & lowerHalfMask;
 
   // computing steps
-  uint32_t step1 = karatsuba(a, c, halfSize);
-  uint32_t step2 = karatsuba(b, d, halfSize);
-  uint32_t step3 = karatsuba((a + b), (c + d), halfSize);
+  uint32_t step1 = karatsubaRecursive(a, c, halfSize);
+  uint32_t step2 = karatsubaRecursive(b, d, halfSize);
+  uint32_t step3 = karatsubaRecursive((a + b), (c + d), halfSize);
   uint32_t gauss = step3 - step2 - step1;
-  return (step1 << (size)) + (gauss << (halfSize)) + step2;
+  // for 32 bits step1 gets shifted out completely, shifting by 32 is
+  // undefined so we need to drop it explicitly
+  uint32_t upper = size < 32 ? (step1 << (size)) : 0;
+  return upper + (gauss << (halfSize)) + step2;
+}
+
+// levels of recursion karatsuba goes through for the given size
+constexpr uint32_t karatsubaLevels(uint32_t size) {
+  return size <= 4 ? 1 : 1 + karatsubaLevels(size >> 1);
+}
+
+inline uint32_t karatsuba(uint32_t x, uint32_t y, uint32_t size) {
+  // counted once per call, a depth scope on every level cost a quarter of
+  // the time of a 16 bits multiplication, the depth only depends on the size
+  KERNELS_COUNT(KaratsubaCalls);
+  KERNELS_COUNT_MAX(KaratsubaDepth, karatsubaLevels(size));
+  return karatsubaRecursive(x, y, size);
 }
 
 template <uint32_t SIZE> uint32_t karatsubaTemplate(uint32_t x, uint32_t y) {
@@ -129,10 +149,58 @@ template <uint32_t SIZE> uint32_t karatsubaTemplate(uint32_t x, uint32_t y) {
   }
 }
 
+// unrolled shift and add multiplication used for the leaves of
+// karatsubaUnrolled, every bit of y selects a shifted copy of x through a
+// mask, so there are no branches and no loop
+template <uint32_t BIT, uint32_t BITS>
+inline uint32_t unrolledShiftAdd(uint32_t x, uint32_t y) {
+  uint32_t partial = (0u - ((y >> BIT) & 1u)) & (x << BIT);
+  if constexpr (BIT + 1 < BITS) {
+    return partial + unrolledShiftAdd<BIT + 1, BITS>(x, y);
+  } else {
+    return partial;
+  }
+}
+
+// fully compile time specialized version of karatsubaTemplate (requires
+// c++17), the base case is an if constexpr so no deeper recursion gets
+// instantiated and the masks are constants folded in the code.
+// EXTRA keeps track of the carry bits that (a+b) and (c+d) add at every
+// level, so that the leaves know how many bits they need to unroll.
+// Operands are expected to fit in SIZE bits, result is x*y modulo 2^32
+template <uint32_t SIZE, uint32_t EXTRA = 0>
+inline uint32_t karatsubaUnrolled(uint32_t x, uint32_t y) {
+  static_assert(SIZE + EXTRA <= 32, "operands must fit in 32 bits");
+  if constexpr (SIZE <= 4) {
+    return unrolledShiftAdd<0, SIZE + EXTRA>(x, y);
+  } else {
+    constexpr uint32_t halfSize = SIZE >> 1;
+    constexpr uint32_t upperSize = SIZE - halfSize;
+    constexpr uint32_t lowerHalfMask = (1u << halfSize) - 1;
+
+    // extracting upper lower part, the upper part keeps any carry bit
+    uint32_t a = x >> halfSize;
+    uint32_t b = x & lowerHalfMask;
+    uint32_t c = y >> halfSize;
+    uint32_t d = y & lowerHalfMask;
+
+    // computing steps
+    uint32_t step1 = karatsubaUnrolled<upperSize, EXTRA>(a, c);
+    uint32_t step2 = karatsubaUnrolled<halfSize>(b, d);
+    uint32_t step3 = karatsubaUnrolled<upperSize, EXTRA + 1>((a + b), (c + d));
+    uint32_t gauss = step3 - step2 - step1;
+    if constexpr (2 * halfSize < 32) {
+      return (step1 << (2 * halfSize)) + (gauss << halfSize) + step2;
+    } else {
+      // step1 would be shifted out completely
+      return (gauss << halfSize) + step2;
+    }
+  }
+}
+
 constexpr uint32_t karatsubaConstExpr(uint32_t x, uint32_t y, uint32_t SIZE) {
   if (SIZE <= 4) {
-    // return ((x == 1) & (y == 1)) ? 2 : simpleMultFaster( x, y);
-    return ((x == 1) & (y == 1)) ? 2 : x * y;
+    return x * y;
   }
   // generating mask
   uint32_t halfSize = SIZE >> 1;
@@ -150,7 +218,8 @@ constexpr uint32_t karatsubaConstExpr(uint32_t x, uint32_t y, uint32_t SIZE) {
   uint32_t step2 = karatsubaConstExpr(b, d, halfSize);
   uint32_t step3 = karatsubaConstExpr((a + b), (c + d), halfSize);
   uint32_t gauss = step3 - step2 - step1;
-  return (step1 << (SIZE)) + (gauss << (halfSize)) + step2;
+  uint32_t upper = SIZE < 32 ? (step1 << (SIZE)) : 0;
+  return upper + (gauss << (halfSize)) + step2;
 }
 
 } // namespace algorithms
@@ -0,0 +1,98 @@
+// compile with g++ -std=c++17 -O3 karatsubaBench.cpp -o karatsubaBench
+// to look at the generated code of the different variants
+// objdump -d -C --no-show-raw-insn karatsubaBench | grep -A60 "<bench"
+
+#include "karatsuba.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace cpp_tools::algorithms;
+
+// the wrappers are not inlined so that each variant shows up as its own
+// symbol in the disassembly
+__attribute__((noinline)) uint32_t benchKaratsuba(uint32_t x, uint32_t y) {
+  return karatsuba(x, y, 16);
+}
+__attribute__((noinline)) uint32_t benchKaratsubaConstExpr(uint32_t x,
+                                                           uint32_t y) {
+  return karatsubaConstExpr(x, y, 16);
+}
+__attribute__((noinline)) uint32_t benchKaratsubaTemplate(uint32_t x,
+                                                          uint32_t y) {
+  return karatsubaTemplate<16>(x, y);
+}
+__attribute__((noinline)) uint32_t benchKaratsubaUnrolled(uint32_t x,
+                                                          uint32_t y) {
+  return karatsubaUnrolled<16>(x, y);
+}
+__attribute__((noinline)) uint32_t benchNative(uint32_t x, uint32_t y) {
+  return x * y;
+}
+
+// keeps the compiler from throwing away the warm up
+static volatile uint32_t sink;
+
+template <typename F>
+uint32_t multiplyAll(F function, const vector<uint32_t> &xs,
+                     const vector<uint32_t> &ys) {
+  uint32_t checksum = 0;
+  for (size_t i = 0; i < xs.size(); ++i) {
+    checksum += function(xs[i], ys[i]);
+  }
+  return checksum;
+}
+
+// returns the time in microseconds, the comparison is skipped when there is
+// no baseline (0) or the run was too short for the clock
+template <typename F>
+double runBenchmark(const char *name, F function, const vector<uint32_t> &xs,
+                    const vector<uint32_t> &ys, double baseline) {
+  auto start = chrono::high_resolution_clock::now();
+  uint32_t checksum = multiplyAll(function, xs, ys);
+  auto end = chrono::high_resolution_clock::now();
+  double t = chrono::duration<double, micro>(end - start).count();
+  std::cout << name << ": " << t << " micro";
+  if (t > 0.0) {
+    std::cout << ", " << (double(xs.size()) / t) << " mult/micro";
+    if (baseline > 0.0) {
+      std::cout << ", vs karatsuba: "
+                << (int)((1.0 - t / baseline) * 100.0) << "%";
+    }
+  } else {
+    std::cout << ", too short to time";
+  }
+  std::cout << " (checksum " << checksum << ")" << std::endl;
+  return t;
+}
+
+int main() {
+  const uint32_t ITERATIONS = 10000000;
+  vector<uint32_t> xs(ITERATIONS);
+  vector<uint32_t> ys(ITERATIONS);
+  for (uint32_t i = 0; i < ITERATIONS; ++i) {
+    xs[i] = static_cast<uint32_t>(rand()) & 0xFFFF;
+    ys[i] = static_cast<uint32_t>(rand()) & 0xFFFF;
+  }
+  std::cout << std::fixed << std::setprecision(1);
+
+  // one untimed pass of every variant, the inputs are in the cache and the
+  // clock has ramped up before the first timed run, which is the baseline
+  sink = multiplyAll(benchKaratsuba, xs, ys) +
+         multiplyAll(benchKaratsubaConstExpr, xs, ys) +
+         multiplyAll(benchKaratsubaTemplate, xs, ys) +
+         multiplyAll(benchKaratsubaUnrolled, xs, ys) +
+         multiplyAll(benchNative, xs, ys);
+
+  double baseline = runBenchmark("karatsuba", benchKaratsuba, xs, ys, 0.0);
+  runBenchmark("karatsubaConstExpr", benchKaratsubaConstExpr, xs, ys, baseline);
+  runBenchmark("karatsubaTemplate", benchKaratsubaTemplate, xs, ys, baseline);
+  runBenchmark("karatsubaUnrolled", benchKaratsubaUnrolled, xs, ys, baseline);
+  runBenchmark("native", benchNative, xs, ys, baseline);
+  return 0;
+}
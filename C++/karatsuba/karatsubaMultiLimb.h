@@ -0,0 +1,154 @@
+#pragma once
+
+#include "../instrumentation/instrumentation.h"
+#include "modular.h"
+#include "scratchArena.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace cpp_tools {
+namespace algorithms {
+
+// below this amount of limbs the schoolbook multiplication wins
+static const size_t KARATSUBA_MULTI_LIMB_THRESHOLD = 16;
+
+// exact amount of scratch limbs needed by karatsubaMultiLimb for operands of
+// the given size. Every level needs (a+b), (c+d) and their product, that is
+// 4 * (upper + 1) limbs, on top of that goes the recursion on the middle
+// product, the other two recursions run before the level allocates anything
+// and are smaller, so they fit in the same space
+constexpr size_t karatsubaScratchLimbs(size_t limbs) {
+  return limbs <= KARATSUBA_MULTI_LIMB_THRESHOLD
+             ? 0
+             : 4 * (limbs - limbs / 2 + 1) +
+                   karatsubaScratchLimbs(limbs - limbs / 2 + 1);
+}
+
+// out[0, 2n) = x[0, n) * y[0, n)
+template <typename WideMultiply = KaratsubaWideMultiply>
+inline void schoolbookMultiLimb(const uint32_t *x, const uint32_t *y,
+                                size_t limbs, uint32_t *out,
+                                WideMultiply multiply = WideMultiply()) {
+  for (size_t i = 0; i < 2 * limbs; ++i) {
+    out[i] = 0;
+  }
+  for (size_t i = 0; i < limbs; ++i) {
+    uint64_t carry = 0;
+    for (size_t j = 0; j < limbs; ++j) {
+      uint64_t sum = out[i + j] + multiply(x[j], y[i]) + carry;
+      out[i + j] = static_cast<uint32_t>(sum);
+      carry = sum >> 32;
+    }
+    out[i + limbs] = static_cast<uint32_t>(carry);
+  }
+}
+
+// out[0, an + 1) = a[0, an) + b[0, bn), expects an >= bn
+inline void addLimbs(const uint32_t *a, size_t an, const uint32_t *b,
+                     size_t bn, uint32_t *out) {
+  uint64_t carry = 0;
+  for (size_t i = 0; i < an; ++i) {
+    uint64_t sum = carry + a[i] + (i < bn ? b[i] : 0u);
+    out[i] = static_cast<uint32_t>(sum);
+    carry = sum >> 32;
+  }
+  out[an] = static_cast<uint32_t>(carry);
+}
+
+// a[0, an) += b[0, bn), the carry is propagated up to the end of a
+inline void addInPlaceLimbs(uint32_t *a, size_t an, const uint32_t *b,
+                            size_t bn) {
+  uint64_t carry = 0;
+  for (size_t i = 0; i < an; ++i) {
+    uint64_t sum = carry + a[i] + (i < bn ? b[i] : 0u);
+    a[i] = static_cast<uint32_t>(sum);
+    carry = sum >> 32;
+  }
+}
+
+// a[0, an) -= b[0, bn), expects a >= b
+inline void subtractInPlaceLimbs(uint32_t *a, size_t an, const uint32_t *b,
+                                 size_t bn) {
+  uint32_t borrow = 0;
+  for (size_t i = 0; i < an; ++i) {
+    uint64_t diff =
+        static_cast<uint64_t>(a[i]) - (i < bn ? b[i] : 0u) - borrow;
+    a[i] = static_cast<uint32_t>(diff);
+    borrow = static_cast<uint32_t>(diff >> 63);
+  }
+}
+
+// the recursion of karatsubaMultiLimb, the arena size is checked once by the
+// caller, the allocations below only assert
+template <typename WideMultiply>
+inline void karatsubaMultiLimbRecursive(const uint32_t *x, const uint32_t *y,
+                                        size_t limbs, uint32_t *out,
+                                        ScratchArena &arena,
+                                        WideMultiply multiply) {
+  KERNELS_COUNT(KaratsubaCalls);
+  KERNELS_DEPTH_SCOPE(KaratsubaDepth);
+  if (limbs <= KARATSUBA_MULTI_LIMB_THRESHOLD) {
+    schoolbookMultiLimb(x, y, limbs, out, multiply);
+    return;
+  }
+
+  // splitting, the lower part is half the limbs and the upper part gets the
+  // remaining one if odd
+  const size_t halfSize = limbs >> 1;
+  const size_t upperSize = limbs - halfSize;
+  const uint32_t *b = x;
+  const uint32_t *a = x + halfSize;
+  const uint32_t *d = y;
+  const uint32_t *c = y + halfSize;
+
+  // step1 and step2 go straight in the output, they do not overlap
+  uint32_t *step2 = out;
+  uint32_t *step1 = out + 2 * halfSize;
+  karatsubaMultiLimbRecursive(b, d, halfSize, step2, arena, multiply);
+  karatsubaMultiLimbRecursive(a, c, upperSize, step1, arena, multiply);
+
+  ScratchScope scope(arena);
+  const size_t sumSize = upperSize + 1;
+  uint32_t *sum1 = arena.allocate(sumSize);
+  uint32_t *sum2 = arena.allocate(sumSize);
+  uint32_t *step3 = arena.allocate(2 * sumSize);
+  addLimbs(a, upperSize, b, halfSize, sum1);
+  addLimbs(c, upperSize, d, halfSize, sum2);
+  karatsubaMultiLimbRecursive(sum1, sum2, sumSize, step3, arena, multiply);
+
+  // gauss trick, step3 - step2 - step1 is always positive
+  subtractInPlaceLimbs(step3, 2 * sumSize, step2, 2 * halfSize);
+  subtractInPlaceLimbs(step3, 2 * sumSize, step1, 2 * upperSize);
+  addInPlaceLimbs(out + halfSize, 2 * limbs - halfSize, step3, 2 * sumSize);
+}
+
+// Multi limb karatsuba, out[0, 2n) = x[0, n) * y[0, n), limbs are little
+// endian. All the temporaries are sliced out of the arena, which needs at
+// least karatsubaScratchLimbs(n) free limbs, nothing is allocated on the heap.
+// Throws std::length_error when the arena is too small, release builds have
+// no assert to catch the overflow later on
+template <typename WideMultiply = KaratsubaWideMultiply>
+inline void karatsubaMultiLimb(const uint32_t *x, const uint32_t *y,
+                               size_t limbs, uint32_t *out,
+                               ScratchArena &arena,
+                               WideMultiply multiply = WideMultiply()) {
+  if (arena.capacity() - arena.used() < karatsubaScratchLimbs(limbs)) {
+    throw std::length_error("scratch arena too small for karatsubaMultiLimb");
+  }
+  karatsubaMultiLimbRecursive(x, y, limbs, out, arena, multiply);
+}
+
+// same as above using the per thread arena, after the first call with a
+// given size no allocation happens
+template <typename WideMultiply = KaratsubaWideMultiply>
+inline void karatsubaMultiLimb(const uint32_t *x, const uint32_t *y,
+                               size_t limbs, uint32_t *out) {
+  KERNELS_TRACE_SCOPE("karatsubaMultiLimb");
+  ScratchArena &arena = threadScratchArena(karatsubaScratchLimbs(limbs));
+  karatsubaMultiLimb(x, y, limbs, out, arena, WideMultiply());
+}
+
+} // namespace algorithms
+} // namespace cpp_tools
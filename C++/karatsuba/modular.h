@@ -0,0 +1,368 @@
+#pragma once
+
+#include "karatsuba.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace cpp_tools {
+namespace algorithms {
+
+// 32x32 -> 64 bits product built out of three 16 bits karatsuba products.
+// (a+b) and (c+d) are 17 bits numbers and their product would not fit in
+// 32 bits, so we split out the carry bit and only multiply the lower 16 bits,
+// the carry contributions are added with masks, no branches
+inline uint64_t karatsubaWide(uint32_t x, uint32_t y) {
+  uint32_t a = x >> 16;
+  uint32_t b = x & 0xFFFF;
+  uint32_t c = y >> 16;
+  uint32_t d = y & 0xFFFF;
+
+  uint64_t step1 = karatsubaUnrolled<16>(a, c);
+  uint64_t step2 = karatsubaUnrolled<16>(b, d);
+
+  uint32_t sum1 = a + b;
+  uint32_t sum2 = c + d;
+  uint32_t sum1Low = sum1 & 0xFFFF;
+  uint32_t sum2Low = sum2 & 0xFFFF;
+  uint32_t sum1Carry = sum1 >> 16;
+  uint32_t sum2Carry = sum2 >> 16;
+  uint64_t cross = static_cast<uint64_t>((0u - sum1Carry) & sum2Low) +
+                   static_cast<uint64_t>((0u - sum2Carry) & sum1Low);
+  uint64_t step3 = karatsubaUnrolled<16>(sum1Low, sum2Low) + (cross << 16) +
+                   (static_cast<uint64_t>(sum1Carry & sum2Carry) << 32);
+
+  uint64_t gauss = step3 - step2 - step1;
+  return (step1 << 32) + (gauss << 16) + step2;
+}
+
+// policies for the 32x32 -> 64 products used by the modular engines, by
+// default we go through karatsuba, the native one is there to compare against
+// and for targets where the hardware multiplier is the better deal
+struct KaratsubaWideMultiply {
+  uint64_t operator()(uint32_t x, uint32_t y) const {
+    return karatsubaWide(x, y);
+  }
+};
+
+struct NativeWideMultiply {
+  uint64_t operator()(uint32_t x, uint32_t y) const {
+    return static_cast<uint64_t>(x) * y;
+  }
+};
+
+// high 64 bits of a 64x64 bits product, composed from four wide products
+template <typename WideMultiply>
+inline uint64_t mulHigh64(uint64_t x, uint64_t y, WideMultiply multiply) {
+  uint32_t xl = static_cast<uint32_t>(x);
+  uint32_t xh = static_cast<uint32_t>(x >> 32);
+  uint32_t yl = static_cast<uint32_t>(y);
+  uint32_t yh = static_cast<uint32_t>(y >> 32);
+
+  uint64_t ll = multiply(xl, yl);
+  uint64_t lh = multiply(xl, yh);
+  uint64_t hl = multiply(xh, yl);
+  uint64_t hh = multiply(xh, yh);
+
+  uint64_t middle = (ll >> 32) + static_cast<uint32_t>(lh) +
+                    static_cast<uint32_t>(hl);
+  return hh + (lh >> 32) + (hl >> 32) + (middle >> 32);
+}
+
+// Montgomery modular arithmetic for an odd 32 bits modulus. Values are kept
+// in Montgomery form (x * 2^32 mod N), the reduction only needs products and
+// shifts, hardware division is used once in the constructor to compute
+// 2^64 mod N and never in the hot path.
+template <typename WideMultiply = KaratsubaWideMultiply> class Montgomery32 {
+public:
+  explicit Montgomery32(uint32_t modulus) : m_modulus(modulus) {
+    // newton iteration for the inverse modulo 2^32, the starting value is
+    // correct on 3 bits and every step doubles them
+    uint32_t inverse = modulus;
+    for (int i = 0; i < 4; ++i) {
+      inverse *= 2 - modulus * inverse;
+    }
+    m_negativeInverse = 0u - inverse;
+
+    uint64_t r = (1ull << 32) % modulus;
+    m_r2 = static_cast<uint32_t>((r * r) % modulus);
+    m_one = static_cast<uint32_t>(r);
+  }
+
+  uint32_t modulus() const { return m_modulus; }
+
+  // given T < N * 2^32 computes T * 2^-32 mod N
+  uint32_t reduce(uint64_t value) const {
+    uint32_t low = static_cast<uint32_t>(value);
+    uint32_t m = karatsubaUnrolled<32>(low, m_negativeInverse);
+    uint64_t mn = m_multiply(m, m_modulus);
+    // the low 32 bits of value + mn are zero by construction, they only
+    // produce a carry if low is not zero
+    uint64_t t = (value >> 32) + (mn >> 32) + (low != 0);
+    uint64_t subtracted = t - m_modulus;
+    return static_cast<uint32_t>(t >= m_modulus ? subtracted : t);
+  }
+
+  // x is expected to be already smaller than the modulus
+  uint32_t toMontgomery(uint32_t x) const {
+    return reduce(m_multiply(x, m_r2));
+  }
+  uint32_t fromMontgomery(uint32_t x) const { return reduce(x); }
+
+  // operands and result in Montgomery form
+  uint32_t multiply(uint32_t a, uint32_t b) const {
+    return reduce(m_multiply(a, b));
+  }
+
+  uint32_t power(uint32_t base, uint64_t exponent) const {
+    uint32_t result = m_one;
+    while (exponent) {
+      uint32_t multiplied = multiply(result, base);
+      result = (exponent & 1) ? multiplied : result;
+      base = multiply(base, base);
+      exponent >>= 1;
+    }
+    return result;
+  }
+
+  // convenience functions in normal form, a * b * 2^-32 is brought back with
+  // a multiplication by 2^64, this saves converting both operands
+  uint32_t modMultiply(uint32_t a, uint32_t b) const {
+    return reduce(m_multiply(reduce(m_multiply(a, b)), m_r2));
+  }
+  uint32_t modPower(uint32_t base, uint64_t exponent) const {
+    return fromMontgomery(power(toMontgomery(base), exponent));
+  }
+
+  // batched versions in normal form, out[i] = a[i] * b[i] mod N
+  void modMultiplyBatch(const uint32_t *a, const uint32_t *b, uint32_t *out,
+                        size_t count) const {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = modMultiply(a[i], b[i]);
+    }
+  }
+  void modPowerBatch(const uint32_t *bases, const uint64_t *exponents,
+                     uint32_t *out, size_t count) const {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = modPower(bases[i], exponents[i]);
+    }
+  }
+
+private:
+  uint32_t m_modulus;
+  uint32_t m_negativeInverse;
+  uint32_t m_r2;
+  uint32_t m_one;
+  WideMultiply m_multiply;
+};
+
+// Barrett reduction for any 32 bits modulus greater than one, works in normal
+// form so it is the better pick for few operations per modulus
+template <typename WideMultiply = KaratsubaWideMultiply> class Barrett32 {
+public:
+  explicit Barrett32(uint32_t modulus)
+      : m_modulus(modulus), m_mu(~0ull / modulus) {}
+
+  uint32_t modulus() const { return m_modulus; }
+
+  // value is expected to be smaller than N^2
+  uint32_t reduce(uint64_t value) const {
+    // the quotient estimate is off by at most two
+    uint64_t q = mulHigh64(value, m_mu, m_multiply);
+    uint64_t r = value - m_multiply(static_cast<uint32_t>(q), m_modulus);
+    uint64_t subtracted = r - m_modulus;
+    r = r >= m_modulus ? subtracted : r;
+    subtracted = r - m_modulus;
+    r = r >= m_modulus ? subtracted : r;
+    return static_cast<uint32_t>(r);
+  }
+
+  // operands are expected to be already smaller than the modulus
+  uint32_t modMultiply(uint32_t a, uint32_t b) const {
+    return reduce(m_multiply(a, b));
+  }
+
+  // base can be anything, modMultiply wants it under N. reduce does that
+  // without a division: the quotient of a 32 bits value fits in 32 bits
+  // even when the value is above N^2, and the estimate is still off by at
+  // most two
+  uint32_t modPower(uint32_t base, uint64_t exponent) const {
+    base = reduce(base);
+    uint32_t result = reduce(1);
+    while (exponent) {
+      uint32_t multiplied = modMultiply(result, base);
+      result = (exponent & 1) ? multiplied : result;
+      base = modMultiply(base, base);
+      exponent >>= 1;
+    }
+    return result;
+  }
+
+  void modMultiplyBatch(const uint32_t *a, const uint32_t *b, uint32_t *out,
+                        size_t count) const {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = modMultiply(a[i], b[i]);
+    }
+  }
+  void modPowerBatch(const uint32_t *bases, const uint64_t *exponents,
+                     uint32_t *out, size_t count) const {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = modPower(bases[i], exponents[i]);
+    }
+  }
+
+private:
+  uint32_t m_modulus;
+  uint64_t m_mu;
+  WideMultiply m_multiply;
+};
+
+// Montgomery arithmetic on LIMBS x 32 bits numbers, limbs are stored little
+// endian. The multiplication is the CIOS (coarsely integrated operand
+// scanning) variant, every limb product goes through the wide multiply.
+// The setup does not use division either, 2^(64*LIMBS) mod N is computed by
+// repeated modular doubling.
+template <size_t LIMBS, typename WideMultiply = KaratsubaWideMultiply>
+class MontgomeryMultiLimb {
+public:
+  using Number = std::array<uint32_t, LIMBS>;
+
+  // modulus has to be odd
+  explicit MontgomeryMultiLimb(const Number &modulus) : m_modulus(modulus) {
+    uint32_t n0 = modulus[0];
+    uint32_t inverse = n0;
+    for (int i = 0; i < 4; ++i) {
+      inverse *= 2 - n0 * inverse;
+    }
+    m_negativeInverse = 0u - inverse;
+
+    Number value{};
+    value[0] = 1;
+    reduceOnce(value, 0);
+    for (size_t i = 0; i < 64 * LIMBS; ++i) {
+      uint32_t carry = 0;
+      for (size_t j = 0; j < LIMBS; ++j) {
+        uint32_t limb = value[j];
+        value[j] = (limb << 1) | carry;
+        carry = limb >> 31;
+      }
+      reduceOnce(value, carry);
+      if (i + 1 == 32 * LIMBS) {
+        m_one = value;
+      }
+    }
+    m_r2 = value;
+  }
+
+  const Number &modulus() const { return m_modulus; }
+
+  // operands and result in Montgomery form
+  Number multiply(const Number &a, const Number &b) const {
+    uint32_t t[LIMBS + 2] = {};
+    for (size_t i = 0; i < LIMBS; ++i) {
+      uint64_t carry = 0;
+      for (size_t j = 0; j < LIMBS; ++j) {
+        uint64_t sum = t[j] + m_multiply(a[j], b[i]) + carry;
+        t[j] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+      }
+      uint64_t sum = t[LIMBS] + carry;
+      t[LIMBS] = static_cast<uint32_t>(sum);
+      t[LIMBS + 1] = static_cast<uint32_t>(sum >> 32);
+
+      uint32_t m = karatsubaUnrolled<32>(t[0], m_negativeInverse);
+      sum = t[0] + m_multiply(m, m_modulus[0]);
+      carry = sum >> 32;
+      for (size_t j = 1; j < LIMBS; ++j) {
+        sum = t[j] + m_multiply(m, m_modulus[j]) + carry;
+        t[j - 1] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+      }
+      sum = t[LIMBS] + carry;
+      t[LIMBS - 1] = static_cast<uint32_t>(sum);
+      t[LIMBS] = t[LIMBS + 1] + static_cast<uint32_t>(sum >> 32);
+    }
+
+    Number result;
+    for (size_t j = 0; j < LIMBS; ++j) {
+      result[j] = t[j];
+    }
+    reduceOnce(result, t[LIMBS]);
+    return result;
+  }
+
+  Number toMontgomery(const Number &x) const { return multiply(x, m_r2); }
+  Number fromMontgomery(const Number &x) const {
+    Number one{};
+    one[0] = 1;
+    return multiply(x, one);
+  }
+
+  // exponent is a little endian array of 32 bits limbs
+  Number power(Number base, const uint32_t *exponent,
+               size_t exponentLimbs) const {
+    Number result = m_one;
+    for (size_t i = 0; i < exponentLimbs; ++i) {
+      uint32_t limb = exponent[i];
+      for (int bit = 0; bit < 32; ++bit) {
+        Number multiplied = multiply(result, base);
+        result = (limb & 1) ? multiplied : result;
+        base = multiply(base, base);
+        limb >>= 1;
+      }
+    }
+    return result;
+  }
+
+  // convenience functions in normal form
+  Number modMultiply(const Number &a, const Number &b) const {
+    return multiply(multiply(a, b), m_r2);
+  }
+  Number modPower(const Number &base, const uint32_t *exponent,
+                  size_t exponentLimbs) const {
+    return fromMontgomery(
+        power(toMontgomery(base), exponent, exponentLimbs));
+  }
+
+  void modMultiplyBatch(const Number *a, const Number *b, Number *out,
+                        size_t count) const {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = modMultiply(a[i], b[i]);
+    }
+  }
+  // all the bases are raised to the same exponent
+  void modPowerBatch(const Number *bases, const uint32_t *exponent,
+                     size_t exponentLimbs, Number *out, size_t count) const {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = modPower(bases[i], exponent, exponentLimbs);
+    }
+  }
+
+private:
+  // value + overflow * 2^(32*LIMBS) is expected to be smaller than 2N,
+  // subtracts the modulus once if needed, the selection is done with a mask
+  void reduceOnce(Number &value, uint32_t overflow) const {
+    Number subtracted;
+    uint32_t borrow = 0;
+    for (size_t j = 0; j < LIMBS; ++j) {
+      uint64_t diff = static_cast<uint64_t>(value[j]) - m_modulus[j] - borrow;
+      subtracted[j] = static_cast<uint32_t>(diff);
+      borrow = static_cast<uint32_t>(diff >> 63);
+    }
+    // we keep the subtraction if there was an overflow or no borrow
+    uint32_t keep = 0u - ((overflow != 0) | (borrow == 0));
+    for (size_t j = 0; j < LIMBS; ++j) {
+      value[j] = (subtracted[j] & keep) | (value[j] & ~keep);
+    }
+  }
+
+  Number m_modulus;
+  Number m_r2;
+  Number m_one;
+  uint32_t m_negativeInverse;
+  WideMultiply m_multiply;
+};
+
+} // namespace algorithms
+} // namespace cpp_tools
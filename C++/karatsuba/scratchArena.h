@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace cpp_tools {
+namespace algorithms {
+
+// Bump allocator for the temporaries of the multi limb algorithms, memory is
+// handed out in 32 bits limbs from a single caller supplied buffer. Releasing
+// is stack like: take a mark, do the work, go back to the mark. Nothing is
+// ever freed to the heap, so once the buffer is big enough the algorithms
+// using it do not allocate at all.
+class ScratchArena {
+public:
+  ScratchArena() = default;
+  ScratchArena(uint32_t *buffer, size_t capacity)
+      : m_buffer(buffer), m_capacity(capacity) {}
+
+  uint32_t *allocate(size_t limbs) {
+    assert(m_used + limbs <= m_capacity && "scratch arena exhausted");
+    uint32_t *ptr = m_buffer + m_used;
+    m_used += limbs;
+    m_highWater = m_used > m_highWater ? m_used : m_highWater;
+    return ptr;
+  }
+
+  size_t mark() const { return m_used; }
+  void release(size_t mark) {
+    assert(mark <= m_used);
+    m_used = mark;
+  }
+
+  size_t used() const { return m_used; }
+  size_t capacity() const { return m_capacity; }
+  // biggest amount of limbs ever in use, handy to validate the planners
+  size_t highWater() const { return m_highWater; }
+
+private:
+  uint32_t *m_buffer = nullptr;
+  size_t m_capacity = 0;
+  size_t m_used = 0;
+  size_t m_highWater = 0;
+};
+
+// releases everything allocated in the scope when going out of it
+class ScratchScope {
+public:
+  explicit ScratchScope(ScratchArena &arena)
+      : m_arena(arena), m_mark(arena.mark()) {}
+  ~ScratchScope() { m_arena.release(m_mark); }
+  ScratchScope(const ScratchScope &) = delete;
+  ScratchScope &operator=(const ScratchScope &) = delete;
+
+private:
+  ScratchArena &m_arena;
+  size_t m_mark;
+};
+
+// per thread arena, the backing storage only grows, it is reallocated when a
+// bigger footprint is requested, which is only allowed while the arena is not
+// in use, steady state requests are served without touching the heap
+inline ScratchArena &threadScratchArena(size_t limbs) {
+  thread_local std::vector<uint32_t> storage;
+  thread_local ScratchArena arena;
+  if (storage.size() < limbs) {
+    assert(arena.used() == 0 && "can't grow an arena in use");
+    storage.resize(limbs);
+    arena = ScratchArena(storage.data(), storage.size());
+  }
+  return arena;
+}
+
+} // namespace algorithms
+} // namespace cpp_tools
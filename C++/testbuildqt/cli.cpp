@@ -0,0 +1,8 @@
+#include <jobcli.h>
+
+// the console without qt, nothing but the kernels gets loaded so it starts
+// in a few milliseconds, for the machines running one job per process
+int main(int argc, char* argv[])
+{
+    return kernel_console::runJobCommandLine(argc, argv);
+}
@@ -0,0 +1,47 @@
+#include <jobs.h>
+#include <cstdio>
+#include <string>
+#ifndef __JOBCLI_H__
+#define __JOBCLI_H__
+
+// command line side of the console, runs one job without any gui and prints
+// its events as csv, used by jobcli and by qttest --headless
+//
+// [--job benchmark|uvmesh|add-sweep|mul-sweep|div-sweep] [--kernel NAME]
+// [--size N] [--threads N] [--samples N] [--workers N] [--progress] [--list]
+// [--trace FILE]
+//
+// --trace writes the kernel counters and trace scopes as chrome trace json,
+// needs a build with KERNELS_INSTRUMENT, otherwise the file has no events
+
+namespace kernel_console {
+
+struct JobOptions
+{
+    std::string job = "benchmark";
+    BenchmarkConfig benchmark;
+    unsigned workers = 1;
+    bool progress = false;
+    bool list = false;
+    std::string tracePath;
+};
+
+// false with the reason in error on a bad command line, --headless and the
+// qt -platform option are skipped so the same command line works for both
+bool parseJobOptions(int argc, const char* const argv[], JobOptions& options, std::string& error);
+
+// runs the job and writes the events to out, the exit code is non zero when
+// the job reported failures
+int runJobs(const JobOptions& options, FILE* out);
+
+// parse and run, what the main functions call
+int runJobCommandLine(int argc, const char* const argv[]);
+
+// milliseconds since the process was started, -1 if unknown. Comes from the
+// process start time of the kernel, which only has clock tick resolution
+// (usually 10ms)
+double processAgeMilliseconds();
+
+}
+
+#endif
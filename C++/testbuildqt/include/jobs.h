@@ -0,0 +1,28 @@
+#include <jobscheduler.h>
+#include <cstddef>
+#include <cstdint>
+#ifndef __JOBS_H__
+#define __JOBS_H__
+
+// the heavy runs the console knows how to schedule, all of them report
+// progress once per block and check for cancellation at the same time
+
+namespace kernel_console {
+
+// runBenchmark, every sample is forwarded as an event
+Job benchmarkJob(const BenchmarkConfig& config);
+
+// offsets a random mesh of the given amount of uvs with offsetUVsBatch,
+// the result has the uvs per second
+Job uvMeshJob(size_t vertices);
+
+enum class SoftFloatOperation { Addition, Multiplication, Division };
+
+// compares the batched soft float operation against the hardware on count
+// operand pairs in the range where both agree bit for bit, the result
+// failures are the mismatches
+Job softFloatSweepJob(SoftFloatOperation operation, uint64_t count);
+
+}
+
+#endif
@@ -0,0 +1,184 @@
+#include <kernelrunner.h>
+#include <spscqueue.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#ifndef __JOBSCHEDULER_H__
+#define __JOBSCHEDULER_H__
+
+namespace kernel_console {
+
+// what the jobs send back to the thread polling the scheduler
+struct JobEvent
+{
+    enum Kind { Progress, Sample, Result, Finished, Cancelled };
+
+    Kind kind = Progress;
+    uint32_t job = 0;
+    // Progress, 0 to 1
+    double progress = 0.0;
+    // Sample, from the benchmark jobs
+    BenchmarkSample sample;
+    // Result, what the job processed and how many items went wrong
+    uint64_t items = 0;
+    uint64_t failures = 0;
+    double seconds = 0.0;
+};
+
+class JobScheduler;
+
+// handed to a running job, only usable from the thread running it
+class JobContext
+{
+public:
+    uint32_t id() const { return jobId; }
+    bool cancelled() const { return cancelFlag->load(std::memory_order_relaxed); }
+    const std::atomic<bool>* cancelToken() const { return cancelFlag.get(); }
+
+    // throttled, calls closer than the scheduler interval are dropped, so it
+    // is fine to call it after every block of work
+    void progress(uint64_t done, uint64_t total);
+    // never dropped
+    void sample(const BenchmarkSample& sample);
+    void result(uint64_t items, uint64_t failures, double seconds);
+
+private:
+    friend class JobScheduler;
+    JobContext(JobScheduler& scheduler, size_t worker, uint32_t id,
+               std::shared_ptr<std::atomic<bool>> cancel);
+
+    JobScheduler& scheduler;
+    size_t worker;
+    uint32_t jobId;
+    std::shared_ptr<std::atomic<bool>> cancelFlag;
+    std::chrono::steady_clock::time_point lastProgress;
+};
+
+typedef std::function<void(JobContext&)> Job;
+
+// Fixed pool of worker threads running jobs in submission order. Every
+// worker owns a lock free queue of events with the thread calling poll as
+// the only consumer, so reporting never takes a lock and never waits on the
+// consumer. When the queue is full the progress updates are dropped and the
+// other events go to an overflow list behind a mutex, until poll empties it.
+// Submitting and polling are meant to be done from the same thread, the gui
+// one in the window
+class JobScheduler
+{
+public:
+    static const size_t EVENT_QUEUE_SIZE = 1024;
+
+    explicit JobScheduler(unsigned workers = std::thread::hardware_concurrency(),
+                          std::chrono::milliseconds progressInterval = std::chrono::milliseconds(33));
+    ~JobScheduler();
+
+    JobScheduler(const JobScheduler&) = delete;
+    JobScheduler& operator=(const JobScheduler&) = delete;
+
+    uint32_t submit(Job job);
+    void cancel(uint32_t job);
+    void cancelAll();
+
+    // jobs queued or running
+    size_t pending() const { return pendingJobs.load(); }
+    unsigned workers() const { return static_cast<unsigned>(threads.size()); }
+
+    // hands every queued event to handler(const JobEvent&), returns how many
+    template <typename Handler>
+    size_t poll(Handler&& handler)
+    {
+        size_t count = 0;
+        JobEvent event;
+        std::deque<JobEvent> overflow;
+        for (std::unique_ptr<Worker>& worker : workerState)
+        {
+            // read first, the worker stops pushing to the queue once the list
+            // has something, so what gets popped below is all older than it
+            const bool overflowed = worker->overflowing.load(std::memory_order_acquire);
+            while (worker->events.tryPop(event))
+            {
+                handle(event, handler);
+                ++count;
+            }
+            if (overflowed)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(worker->overflowMutex);
+                    overflow.swap(worker->overflow);
+                    worker->overflowing.store(false, std::memory_order_release);
+                }
+                for (const JobEvent& queued : overflow)
+                {
+                    handle(queued, handler);
+                    ++count;
+                }
+                overflow.clear();
+            }
+        }
+        return count;
+    }
+
+    // blocks until every submitted job has returned, the events stay queued
+    // for the next poll. Nothing has to poll meanwhile, the workers never
+    // wait on a full queue
+    void waitIdle();
+
+private:
+    friend class JobContext;
+
+    struct Worker
+    {
+        SpscQueue<JobEvent, EVENT_QUEUE_SIZE> events;
+        // events that did not fit in the queue, in order, set while the list
+        // is not empty
+        std::atomic<bool> overflowing{false};
+        std::mutex overflowMutex;
+        std::deque<JobEvent> overflow;
+    };
+
+    struct QueuedJob
+    {
+        // zero is never handed out
+        uint32_t id = 0;
+        Job job;
+        std::shared_ptr<std::atomic<bool>> cancel;
+    };
+
+    void workerLoop(size_t worker);
+    bool push(size_t worker, const JobEvent& event, bool droppable);
+
+    template <typename Handler>
+    void handle(const JobEvent& event, Handler& handler)
+    {
+        if (event.kind == JobEvent::Finished || event.kind == JobEvent::Cancelled)
+        {
+            --pendingJobs;
+        }
+        handler(event);
+    }
+
+    std::chrono::steady_clock::duration progressInterval;
+    std::vector<std::unique_ptr<Worker>> workerState;
+    std::vector<std::thread> threads;
+
+    // the mutex only guards the job lists, idle workers sleep on queueSignal
+    // which gets bumped on every submit
+    std::mutex mutex;
+    std::deque<QueuedJob> queue;
+    std::vector<std::pair<uint32_t, std::shared_ptr<std::atomic<bool>>>> running;
+    uint32_t nextId = 1;
+    bool stopping = false;
+    std::atomic<uint32_t> queueSignal{0};
+    std::atomic<size_t> unfinished{0};
+    std::atomic<size_t> pendingJobs{0};
+};
+
+}
+
+#endif
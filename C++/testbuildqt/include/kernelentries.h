@@ -0,0 +1,40 @@
+#include <kernelrunner.h>
+#include <cstdint>
+#include <vector>
+#ifndef __KERNELENTRIES_H__
+#define __KERNELENTRIES_H__
+
+// the kernel table of kernelrunner.cpp, shared with the per instruction set
+// copies of the single call kernels (singlecallkernels.cpp)
+
+namespace kernel_console {
+
+struct Inputs
+{
+    std::vector<float> uvs;
+    std::vector<uint32_t> integers;
+    std::vector<float> floats;
+};
+
+// processes [begin, end) of the inputs, output is per thread scratch space,
+// the return value goes in a checksum so nothing gets optimized away
+typedef uint32_t (*ChunkFunction)(const Inputs&, std::vector<float>&, size_t, size_t);
+
+struct KernelEntry
+{
+    KernelInfo info;
+    ChunkFunction function;
+};
+
+// the single call kernels get inlined in their loops, what they compile to
+// depends on the flags, so there is one table per instruction set
+#define KERNEL_CONSOLE_SINGLE_CALL_DECLARE(SUFFIX) \
+    const std::vector<KernelEntry>& singleCallKernels##SUFFIX();
+
+KERNEL_CONSOLE_SINGLE_CALL_DECLARE(Scalar)
+KERNEL_CONSOLE_SINGLE_CALL_DECLARE(Avx2)
+KERNEL_CONSOLE_SINGLE_CALL_DECLARE(Avx512)
+
+}
+
+#endif
@@ -0,0 +1,56 @@
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <vector>
+#ifndef __KERNELRUNNER_H__
+#define __KERNELRUNNER_H__
+
+// Qt free side of the benchmark console, knows about the kernels and how to
+// time them, the window only drives it and shows the samples
+
+namespace kernel_console {
+
+enum class KernelFamily { UVOffset, Karatsuba, SoftFloat };
+
+struct KernelInfo
+{
+    const char* name;
+    KernelFamily family;
+};
+
+// every kernel the console can run, indices are stable for the whole run
+const std::vector<KernelInfo>& availableKernels();
+const char* familyName(KernelFamily family);
+
+struct BenchmarkConfig
+{
+    size_t kernelIndex = 0;
+    // elements processed by every thread in every sample
+    size_t inputSize = 1 << 16;
+    unsigned threads = 1;
+    unsigned samples = 20;
+};
+
+struct BenchmarkSample
+{
+    unsigned index = 0;
+    // calls per second, all threads together
+    double throughput = 0.0;
+    // nanoseconds per call, computed on chunks of calls
+    double latencyP50 = 0.0;
+    double latencyP90 = 0.0;
+    double latencyP99 = 0.0;
+};
+
+// runs the benchmark calling onSample after every sample, always from the
+// calling thread, stops early as soon as cancel becomes true
+void runBenchmark(const BenchmarkConfig& config,
+                  const std::function<void(const BenchmarkSample&)>& onSample,
+                  const std::atomic<bool>* cancel = nullptr);
+
+// value at the given percentile (0-100), reorders the vector
+double percentile(std::vector<double>& values, double percent);
+
+}
+
+#endif
@@ -0,0 +1,41 @@
+#include <QtGui/QColor>
+#include <QtWidgets/QWidget>
+#include <QtCore/QString>
+#include <QtCore/QVector>
+#ifndef __PLOTWIDGET_H__
+#define __PLOTWIDGET_H__
+
+// minimal line plot, every series keeps its last values and the vertical
+// axis follows the biggest one on screen
+class PlotWidget : public QWidget
+{
+	Q_OBJECT
+
+public:
+	explicit PlotWidget(const QString& title, QWidget *parent = 0);
+
+	int addSeries(const QString& name, const QColor& color);
+	void append(int series, double value);
+	void clear();
+
+	void setHistory(int points);
+
+	QSize minimumSizeHint() const override;
+
+protected:
+	void paintEvent(QPaintEvent *event) override;
+
+private:
+	struct Series
+	{
+		QString name;
+		QColor color;
+		QVector<double> values;
+	};
+
+	QString title;
+	QVector<Series> series;
+	int history;
+};
+
+#endif
@@ -0,0 +1,74 @@
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#ifndef __SPSCQUEUE_H__
+#define __SPSCQUEUE_H__
+
+namespace kernel_console {
+
+// bounded single producer single consumer ring, lock free and wait free.
+// Head and tail live on their own cache lines and each side keeps a copy of
+// the other side index, so the shared lines are only touched when the cached
+// copy says the queue looks full or empty
+template <typename T, size_t CAPACITY>
+class SpscQueue
+{
+    static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "capacity must be a power of two");
+    static_assert(std::is_trivially_copyable<T>::value, "events are copied around, keep them plain");
+
+public:
+    // producer side, false when the queue is full
+    bool tryPush(const T& value)
+    {
+        const size_t tail = tailIndex.load(std::memory_order_relaxed);
+        if (tail - cachedHead == CAPACITY)
+        {
+            cachedHead = headIndex.load(std::memory_order_acquire);
+            if (tail - cachedHead == CAPACITY)
+            {
+                return false;
+            }
+        }
+        ring[tail & (CAPACITY - 1)] = value;
+        tailIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer side, false when the queue is empty
+    bool tryPop(T& value)
+    {
+        const size_t head = headIndex.load(std::memory_order_relaxed);
+        if (head == cachedTail)
+        {
+            cachedTail = tailIndex.load(std::memory_order_acquire);
+            if (head == cachedTail)
+            {
+                return false;
+            }
+        }
+        value = ring[head & (CAPACITY - 1)];
+        headIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // only a hint when called while the other side is running
+    size_t sizeApprox() const
+    {
+        return tailIndex.load(std::memory_order_acquire) - headIndex.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return CAPACITY; }
+
+private:
+    static const size_t CACHE_LINE = 64;
+
+    alignas(CACHE_LINE) std::atomic<size_t> headIndex{0};
+    size_t cachedTail = 0;
+    alignas(CACHE_LINE) std::atomic<size_t> tailIndex{0};
+    size_t cachedHead = 0;
+    alignas(CACHE_LINE) T ring[CAPACITY];
+};
+
+}
+
+#endif
@@ -1,18 +1,78 @@
 #include <ui_mainwindow.h>
+#include <jobscheduler.h>
+#include <QtCore/QTimer>
 #include <QtWidgets/QMainWindow>
+#include <memory>
 #ifndef __MAINWINDOW_H__
 #define __MAINWINDOW_H__
 
+class QComboBox;
+class QLabel;
+class QProgressBar;
+class QPushButton;
+class QSpinBox;
+class QVBoxLayout;
+class PlotWidget;
 
+// benchmark dashboard, pick a job, kernel, input size and thread count and
+// watch throughput and latency percentiles while it runs. The jobs run on
+// the scheduler pool, the window drains their events from a timer so the
+// gui thread never waits on them
 class TestWindow : public QMainWindow
 {
 	Q_OBJECT
 
 public:
 	explicit TestWindow(QMainWindow *parent = 0);
+	~TestWindow();
+
+public slots:
+	// a short benchmark through the whole dashboard, the application exits
+	// when it is done, with 1 if it got cancelled, processed nothing or
+	// reported failures
+	void runSmokeJob();
+
+protected:
+	void showEvent(QShowEvent *event) override;
+
+private slots:
+	void submitJob();
+	void cancelJobs();
+	void pollJobs();
 
 private:
-	 Ui_MainWindow ui;
+	void buildDashboard();
+	void buildPlots();
+	kernel_console::JobScheduler& jobScheduler();
+	void handleEvent(const kernel_console::JobEvent& event);
+	void updateStatus();
+
+	Ui_MainWindow ui;
+
+	QComboBox *jobBox;
+	QComboBox *kernelBox;
+	QSpinBox *sizeBox;
+	QSpinBox *threadBox;
+	QSpinBox *sampleBox;
+	QPushButton *runButton;
+	QPushButton *stopButton;
+	QProgressBar *progressBar;
+	QLabel *statusLabel;
+	QVBoxLayout *plotLayout;
+	PlotWidget *throughputPlot;
+	PlotWidget *latencyPlot;
+	int throughputSeries;
+	int p50Series;
+	int p90Series;
+	int p99Series;
+
+	std::unique_ptr<kernel_console::JobScheduler> scheduler;
+	QTimer pollTimer;
+	// the plots and the progress bar follow the last submitted job
+	uint32_t currentJob;
+	QString lastResult;
+	bool quitWhenDone;
+	bool failed;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -1,15 +1,44 @@
+#include <QtCore/QTimer>
 #include <QtWidgets/QApplication>
+#include <jobcli.h>
 #include <testwindow.h>
 
+#include <cstdio>
+#include <cstring>
+
 
 int main( int argc, char* argv[]) 
 {
+    // --headless runs the job before the application exists, no display and
+    // none of qt gets initialized, the rest of the command line is the one of
+    // jobcli. Without a display at all -platform offscreen still gives the
+    // full window. --smoke runs a short benchmark through the window and
+    // exits, that is the ctest of the qt build
+    bool startupTime = false;
+    bool smoke = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--headless") == 0)
+        {
+            return kernel_console::runJobCommandLine(argc, argv);
+        }
+        startupTime |= std::strcmp(argv[i], "--startup-time") == 0;
+        smoke |= std::strcmp(argv[i], "--smoke") == 0;
+    }
 
     QApplication a(argc, argv);
     TestWindow w;
     w.show();
+    if (startupTime)
+    {
+        // first event loop iteration, the window has been built and shown
+        QTimer::singleShot(0, [] {
+            std::fprintf(stderr, "startup: %.1f ms since exec\n", kernel_console::processAgeMilliseconds());
+        });
+    }
+    if (smoke)
+    {
+        QTimer::singleShot(0, &w, &TestWindow::runSmokeJob);
+    }
     return a.exec();
-
-
-
-}
\ No newline at end of file
+}
@@ -0,0 +1,293 @@
+#include <jobcli.h>
+
+#include "../../instrumentation/instrumentation.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#if defined(__linux__)
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace kernel_console {
+
+namespace {
+
+bool parseUnsigned(const char* text, unsigned long long& value)
+{
+    char* end = nullptr;
+    value = std::strtoull(text, &end, 10);
+    return end != text && *end == 0;
+}
+
+bool findKernel(const std::string& name, size_t& index)
+{
+    const std::vector<KernelInfo>& kernels = availableKernels();
+    for (size_t i = 0; i < kernels.size(); ++i)
+    {
+        if (name == kernels[i].name)
+        {
+            index = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool makeJob(const JobOptions& options, Job& job)
+{
+    const size_t size = options.benchmark.inputSize;
+    if (options.job == "benchmark")
+    {
+        job = benchmarkJob(options.benchmark);
+    }
+    else if (options.job == "uvmesh")
+    {
+        job = uvMeshJob(size);
+    }
+    else if (options.job == "add-sweep")
+    {
+        job = softFloatSweepJob(SoftFloatOperation::Addition, size);
+    }
+    else if (options.job == "mul-sweep")
+    {
+        job = softFloatSweepJob(SoftFloatOperation::Multiplication, size);
+    }
+    else if (options.job == "div-sweep")
+    {
+        job = softFloatSweepJob(SoftFloatOperation::Division, size);
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+}
+
+bool parseJobOptions(int argc, const char* const argv[], JobOptions& options, std::string& error)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string option = argv[i];
+        if (option == "--headless")
+        {
+            continue;
+        }
+        if (option == "--progress")
+        {
+            options.progress = true;
+            continue;
+        }
+        if (option == "--list")
+        {
+            options.list = true;
+            continue;
+        }
+        if (i + 1 >= argc)
+        {
+            error = "missing value for " + option;
+            return false;
+        }
+        const char* value = argv[++i];
+        unsigned long long number = 0;
+        if (option == "-platform")
+        {
+            continue;
+        }
+        else if (option == "--job")
+        {
+            options.job = value;
+            Job unused;
+            if (!makeJob(options, unused))
+            {
+                error = "unknown job " + options.job;
+                return false;
+            }
+        }
+        else if (option == "--trace")
+        {
+            options.tracePath = value;
+        }
+        else if (option == "--kernel")
+        {
+            if (!findKernel(value, options.benchmark.kernelIndex))
+            {
+                error = std::string("unknown kernel ") + value;
+                return false;
+            }
+        }
+        else if (option == "--size" || option == "--threads" || option == "--samples" || option == "--workers")
+        {
+            if (!parseUnsigned(value, number) || number == 0)
+            {
+                error = option + " needs a positive number";
+                return false;
+            }
+            if (option == "--size")
+            {
+                options.benchmark.inputSize = number;
+            }
+            else if (option == "--threads")
+            {
+                options.benchmark.threads = unsigned(number);
+            }
+            else if (option == "--samples")
+            {
+                options.benchmark.samples = unsigned(number);
+            }
+            else
+            {
+                options.workers = unsigned(number);
+            }
+        }
+        else
+        {
+            error = "unknown option " + option;
+            return false;
+        }
+    }
+    return true;
+}
+
+int runJobs(const JobOptions& options, FILE* out)
+{
+    if (options.list)
+    {
+        for (const KernelInfo& kernel : availableKernels())
+        {
+            std::fprintf(out, "%s,%s\n", familyName(kernel.family), kernel.name);
+        }
+        return 0;
+    }
+
+    Job job;
+    if (!makeJob(options, job))
+    {
+        return 1;
+    }
+
+    JobScheduler scheduler(options.workers);
+    scheduler.submit(job);
+
+    std::fprintf(out, "event,job,progress,throughput,p50,p90,p99,items,failures,seconds\n");
+    uint64_t failures = 0;
+    bool cancelled = false;
+    auto print = [&](const JobEvent& event) {
+        switch (event.kind)
+        {
+        case JobEvent::Progress:
+            if (options.progress)
+            {
+                std::fprintf(out, "progress,%u,%.4f,,,,,,,\n", event.job, event.progress);
+            }
+            break;
+        case JobEvent::Sample:
+            std::fprintf(out, "sample,%u,,%.6g,%.4g,%.4g,%.4g,,,\n", event.job, event.sample.throughput,
+                         event.sample.latencyP50, event.sample.latencyP90, event.sample.latencyP99);
+            break;
+        case JobEvent::Result:
+            failures += event.failures;
+            std::fprintf(out, "result,%u,1,%.6g,,,,%llu,%llu,%.6f\n", event.job,
+                         event.seconds > 0.0 ? event.items / event.seconds : 0.0,
+                         (unsigned long long)event.items, (unsigned long long)event.failures, event.seconds);
+            break;
+        case JobEvent::Finished:
+            break;
+        case JobEvent::Cancelled:
+            cancelled = true;
+            break;
+        }
+    };
+    // nobody is waiting on a window here, polling at a few ms keeps the
+    // queues short without spinning
+    while (scheduler.pending())
+    {
+        if (!scheduler.poll(print))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+    std::fflush(out);
+    if (!options.tracePath.empty())
+    {
+        if (!instrumentation::enabled())
+        {
+            std::fprintf(stderr, "built without KERNELS_INSTRUMENT, the trace is empty\n");
+        }
+        if (!instrumentation::writeChromeTrace(options.tracePath))
+        {
+            std::fprintf(stderr, "can not write %s\n", options.tracePath.c_str());
+            return 1;
+        }
+    }
+    return failures || cancelled ? 2 : 0;
+}
+
+int runJobCommandLine(int argc, const char* const argv[])
+{
+    auto mainStart = std::chrono::steady_clock::now();
+    const double startAge = processAgeMilliseconds();
+
+    JobOptions options;
+    std::string error;
+    if (!parseJobOptions(argc, argv, options, error))
+    {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    // startup is measured up to the job getting handed to the scheduler, the
+    // first thing that does useful work
+    auto ready = std::chrono::steady_clock::now();
+    double parse = std::chrono::duration<double, std::milli>(ready - mainStart).count();
+    if (startAge >= 0.0)
+    {
+        std::fprintf(stderr, "startup: %.1f ms since exec (before main %.1f ms)\n", startAge + parse, startAge);
+    }
+    else
+    {
+        std::fprintf(stderr, "startup: %.3f ms since main\n", parse);
+    }
+    return runJobs(options, stdout);
+}
+
+double processAgeMilliseconds()
+{
+#if defined(__linux__)
+    // field 22 of /proc/self/stat, after the command name which can contain
+    // spaces, so the fields are counted from the closing parenthesis
+    std::ifstream file("/proc/self/stat");
+    std::string stat((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    size_t close = stat.rfind(')');
+    if (close == std::string::npos)
+    {
+        return -1.0;
+    }
+    std::istringstream fields(stat.substr(close + 2));
+    std::string field;
+    // state is field 3, starttime field 22
+    for (int i = 3; i < 22 && fields >> field; ++i)
+    {
+    }
+    unsigned long long startTicks = 0;
+    if (!(fields >> startTicks))
+    {
+        return -1.0;
+    }
+    timespec now;
+    clock_gettime(CLOCK_BOOTTIME, &now);
+    double uptime = now.tv_sec * 1000.0 + now.tv_nsec / 1e6;
+    return uptime - startTicks * 1000.0 / double(sysconf(_SC_CLK_TCK));
+#else
+    return -1.0;
+#endif
+}
+
+}
@@ -0,0 +1,117 @@
+#include <jobs.h>
+
+#include "../../branchless/uvBatch.h"
+#include "../../floatingPoint/softFloatBatch.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace kernel_console {
+
+namespace {
+
+// big enough for the progress check to vanish next to the work, small
+// enough for a cancel to be noticed right away
+const size_t BLOCK = 1 << 16;
+
+double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+Job benchmarkJob(const BenchmarkConfig& config)
+{
+    return [config](JobContext& context) {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t samples = 0;
+        runBenchmark(config, [&](const BenchmarkSample& sample) {
+            context.sample(sample);
+            context.progress(++samples, config.samples);
+        }, context.cancelToken());
+        context.result(samples * config.inputSize * std::max(config.threads, 1u), 0, secondsSince(start));
+    };
+}
+
+Job uvMeshJob(size_t vertices)
+{
+    return [vertices](JobContext& context) {
+        std::vector<float> uvs(2*vertices);
+        std::vector<float> offset(2*vertices);
+        std::mt19937 rng(vertices);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        for (float& value : uvs)
+        {
+            value = unit(rng);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        size_t done = 0;
+        while (done < vertices && !context.cancelled())
+        {
+            size_t count = std::min(BLOCK, vertices - done);
+            offsetUVsBatch(&uvs[2*done], &offset[2*done], count);
+            done += count;
+            context.progress(done, vertices);
+        }
+        context.result(done, 0, secondsSince(start));
+    };
+}
+
+Job softFloatSweepJob(SoftFloatOperation operation, uint64_t count)
+{
+    return [operation, count](JobContext& context) {
+        std::vector<float> a(BLOCK);
+        std::vector<float> b(BLOCK);
+        std::vector<float> soft(BLOCK);
+        std::mt19937 rng(static_cast<uint32_t>(count));
+        auto randomNormal = [&rng]() {
+            // exponents in [65, 189], the results stay normal
+            uint32_t bits = (rng() & 0x807FFFFFu) | ((65 + rng() % 125) << 23);
+            float value;
+            std::memcpy(&value, &bits, sizeof(bits));
+            return value;
+        };
+
+        auto start = std::chrono::steady_clock::now();
+        uint64_t done = 0;
+        uint64_t failures = 0;
+        while (done < count && !context.cancelled())
+        {
+            size_t block = static_cast<size_t>(std::min<uint64_t>(BLOCK, count - done));
+            for (size_t i = 0; i < block; ++i)
+            {
+                a[i] = randomNormal();
+                b[i] = randomNormal();
+            }
+            switch (operation)
+            {
+            case SoftFloatOperation::Addition:
+                swFloatAdditionBatch(a.data(), b.data(), soft.data(), block);
+                break;
+            case SoftFloatOperation::Multiplication:
+                swFloatMultiplicationBatch(a.data(), b.data(), soft.data(), block);
+                break;
+            case SoftFloatOperation::Division:
+                swFloatDivisionBatch(a.data(), b.data(), soft.data(), block);
+                break;
+            }
+            for (size_t i = 0; i < block; ++i)
+            {
+                float hardware = operation == SoftFloatOperation::Addition ? a[i] + b[i]
+                               : operation == SoftFloatOperation::Multiplication ? a[i] * b[i]
+                                                                                 : a[i] / b[i];
+                failures += std::memcmp(&hardware, &soft[i], sizeof(float)) != 0;
+            }
+            done += block;
+            context.progress(done, count);
+        }
+        context.result(done, failures, secondsSince(start));
+    };
+}
+
+}
@@ -0,0 +1,209 @@
+#include <jobscheduler.h>
+
+#include "../../instrumentation/instrumentation.h"
+
+#include <algorithm>
+
+namespace kernel_console {
+
+JobContext::JobContext(JobScheduler& scheduler, size_t worker, uint32_t id,
+                       std::shared_ptr<std::atomic<bool>> cancel)
+    : scheduler(scheduler), worker(worker), jobId(id), cancelFlag(std::move(cancel)),
+      lastProgress(std::chrono::steady_clock::now() - scheduler.progressInterval)
+{
+}
+
+void JobContext::progress(uint64_t done, uint64_t total)
+{
+    // the clock is the only cost when the update gets dropped
+    auto now = std::chrono::steady_clock::now();
+    if (now - lastProgress < scheduler.progressInterval && done < total)
+    {
+        return;
+    }
+    JobEvent event;
+    event.kind = JobEvent::Progress;
+    event.job = jobId;
+    event.progress = total ? double(done) / double(total) : 1.0;
+    // a full queue means the consumer is behind, it will get the next one
+    if (scheduler.push(worker, event, true))
+    {
+        lastProgress = now;
+    }
+}
+
+void JobContext::sample(const BenchmarkSample& value)
+{
+    JobEvent event;
+    event.kind = JobEvent::Sample;
+    event.job = jobId;
+    event.sample = value;
+    scheduler.push(worker, event, false);
+}
+
+void JobContext::result(uint64_t items, uint64_t failures, double seconds)
+{
+    JobEvent event;
+    event.kind = JobEvent::Result;
+    event.job = jobId;
+    event.items = items;
+    event.failures = failures;
+    event.seconds = seconds;
+    scheduler.push(worker, event, false);
+}
+
+JobScheduler::JobScheduler(unsigned workers, std::chrono::milliseconds interval)
+    : progressInterval(interval)
+{
+    workers = std::max(workers, 1u);
+    for (unsigned i = 0; i < workers; ++i)
+    {
+        workerState.push_back(std::make_unique<Worker>());
+    }
+    for (unsigned i = 0; i < workers; ++i)
+    {
+        threads.emplace_back(&JobScheduler::workerLoop, this, i);
+    }
+}
+
+JobScheduler::~JobScheduler()
+{
+    cancelAll();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    queueSignal.fetch_add(1, std::memory_order_release);
+    queueSignal.notify_all();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+uint32_t JobScheduler::submit(Job job)
+{
+    uint32_t id;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        id = nextId++;
+        queue.push_back({id, std::move(job), std::make_shared<std::atomic<bool>>(false)});
+        ++unfinished;
+    }
+    ++pendingJobs;
+    queueSignal.fetch_add(1, std::memory_order_release);
+    queueSignal.notify_one();
+    return id;
+}
+
+void JobScheduler::cancel(uint32_t job)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (QueuedJob& queued : queue)
+    {
+        if (queued.id == job)
+        {
+            *queued.cancel = true;
+        }
+    }
+    for (auto& active : running)
+    {
+        if (active.first == job)
+        {
+            *active.second = true;
+        }
+    }
+}
+
+void JobScheduler::cancelAll()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (QueuedJob& queued : queue)
+    {
+        *queued.cancel = true;
+    }
+    for (auto& active : running)
+    {
+        *active.second = true;
+    }
+}
+
+void JobScheduler::waitIdle()
+{
+    for (size_t left = unfinished.load(); left != 0; left = unfinished.load())
+    {
+        unfinished.wait(left);
+    }
+}
+
+bool JobScheduler::push(size_t worker, const JobEvent& event, bool droppable)
+{
+    Worker& state = *workerState[worker];
+    // once something overflowed everything goes after it until poll took
+    // the list, otherwise a Finished could overtake the Result before it
+    if (!state.overflowing.load(std::memory_order_acquire) && state.events.tryPush(event))
+    {
+        return true;
+    }
+    if (droppable)
+    {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(state.overflowMutex);
+    state.overflow.push_back(event);
+    state.overflowing.store(true, std::memory_order_release);
+    return true;
+}
+
+void JobScheduler::workerLoop(size_t worker)
+{
+    //the kernels only count, the worker has to show up in the snapshots
+    instrumentation::registerThisThread();
+    for (;;)
+    {
+        // read before looking at the queue, a submit landing in between
+        // changes it and the wait below returns right away
+        const uint32_t signal = queueSignal.load(std::memory_order_acquire);
+        QueuedJob job;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (queue.empty() && stopping)
+            {
+                return;
+            }
+            if (!queue.empty())
+            {
+                job = std::move(queue.front());
+                queue.pop_front();
+                running.emplace_back(job.id, job.cancel);
+            }
+        }
+        if (job.id == 0)
+        {
+            queueSignal.wait(signal, std::memory_order_acquire);
+            continue;
+        }
+
+        JobContext context(*this, worker, job.id, job.cancel);
+        if (!context.cancelled())
+        {
+            job.job(context);
+        }
+
+        JobEvent done;
+        done.kind = context.cancelled() ? JobEvent::Cancelled : JobEvent::Finished;
+        done.job = job.id;
+        done.progress = 1.0;
+        push(worker, done, false);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running.erase(std::find_if(running.begin(), running.end(),
+                                       [&](const auto& active) { return active.first == job.id; }));
+        }
+        --unfinished;
+        unfinished.notify_all();
+    }
+}
+
+}
@@ -0,0 +1,312 @@
+#include <kernelentries.h>
+
+#include "../../branchless/uvBatch.h"
+#include "../../dispatch/isaDispatch.h"
+#include "../../floatingPoint/softFloatBatch.h"
+#include "../../instrumentation/instrumentation.h"
+#include "../../karatsuba/karatsuba.h"
+
+#include <algorithm>
+#include <barrier>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace kernel_console {
+
+namespace {
+
+// calls timed together to get one latency value, a single call is too short
+// to be measured reliably
+const size_t CHUNK = 256;
+
+uint32_t uvBatch(const Inputs& in, std::vector<float>& out, size_t begin, size_t end)
+{
+    offsetUVsBatch(&in.uvs[2*begin], &out[2*begin], end - begin);
+    uint32_t bits;
+    std::memcpy(&bits, &out[2*begin], sizeof(bits));
+    return bits;
+}
+
+template <typename F>
+uint32_t integerPairs(const Inputs& in, size_t begin, size_t end, F multiply)
+{
+    uint32_t checksum = 0;
+    for (size_t i = begin; i < end; ++i)
+    {
+        checksum += multiply(in.integers[2*i], in.integers[2*i+1]);
+    }
+    return checksum;
+}
+
+uint32_t karatsubaRuntime(const Inputs& in, std::vector<float>&, size_t begin, size_t end)
+{
+    return integerPairs(in, begin, end, [](uint32_t x, uint32_t y) {
+        return cpp_tools::algorithms::karatsuba(x, y, 16);
+    });
+}
+
+uint32_t karatsubaConstExprRuntime(const Inputs& in, std::vector<float>&, size_t begin, size_t end)
+{
+    return integerPairs(in, begin, end, [](uint32_t x, uint32_t y) {
+        return cpp_tools::algorithms::karatsubaConstExpr(x, y, 16);
+    });
+}
+
+uint32_t karatsubaTemplate16(const Inputs& in, std::vector<float>&, size_t begin, size_t end)
+{
+    return integerPairs(in, begin, end, [](uint32_t x, uint32_t y) {
+        return cpp_tools::algorithms::karatsubaTemplate<16>(x, y);
+    });
+}
+
+uint32_t karatsubaUnrolled16(const Inputs& in, std::vector<float>&, size_t begin, size_t end)
+{
+    return integerPairs(in, begin, end, [](uint32_t x, uint32_t y) {
+        return cpp_tools::algorithms::karatsubaUnrolled<16>(x, y);
+    });
+}
+
+uint32_t nativeMultiply(const Inputs& in, std::vector<float>&, size_t begin, size_t end)
+{
+    return integerPairs(in, begin, end, [](uint32_t x, uint32_t y) { return x * y; });
+}
+
+template <void (*BATCH)(const float*, const float*, float*, size_t)>
+uint32_t softFloatBatch(const Inputs& in, std::vector<float>& out, size_t begin, size_t end)
+{
+    // the batch wants separated operands, the scratch holds a, b and the result
+    const size_t count = end - begin;
+    float* a = &out[2*begin];
+    float* b = a + count;
+    for (size_t i = 0; i < count; ++i)
+    {
+        a[i] = in.floats[2*(begin+i)];
+        b[i] = in.floats[2*(begin+i)+1];
+    }
+    BATCH(a, b, a, count);
+    uint32_t bits;
+    std::memcpy(&bits, a, sizeof(bits));
+    return bits;
+}
+
+const std::vector<KernelEntry>& kernelEntries()
+{
+    // the single call kernels come once per instruction set of the cpu,
+    // named after it, so the lzcnt and bmi2 versions can be timed against
+    // the scalar ones. The others dispatch inside or don't depend on it
+    static const std::vector<KernelEntry> others = {
+        {{"offsetUVsBatch", KernelFamily::UVOffset}, uvBatch},
+        {{"karatsuba", KernelFamily::Karatsuba}, karatsubaRuntime},
+        {{"karatsubaConstExpr", KernelFamily::Karatsuba}, karatsubaConstExprRuntime},
+        {{"karatsubaTemplate", KernelFamily::Karatsuba}, karatsubaTemplate16},
+        {{"karatsubaUnrolled", KernelFamily::Karatsuba}, karatsubaUnrolled16},
+        {{"native multiply", KernelFamily::Karatsuba}, nativeMultiply},
+        {{"swFloatAdditionBatch", KernelFamily::SoftFloat}, softFloatBatch<swFloatAdditionBatch>},
+        {{"swFloatMultiplicationBatch", KernelFamily::SoftFloat}, softFloatBatch<swFloatMultiplicationBatch>},
+        {{"swFloatDivisionBatch", KernelFamily::SoftFloat}, softFloatBatch<swFloatDivisionBatch>},
+    };
+    struct IsaKernels
+    {
+        dispatch::Isa isa;
+        const std::vector<KernelEntry>& (*kernels)();
+    };
+    static const IsaKernels isas[] = {
+        {dispatch::Isa::Scalar, singleCallKernelsScalar},
+        {dispatch::Isa::Avx2, singleCallKernelsAvx2},
+        {dispatch::Isa::Avx512, singleCallKernelsAvx512},
+    };
+    // the names the entries point to, a deque never moves them
+    static std::deque<std::string> names;
+    static const std::vector<KernelEntry> entries = [] {
+        std::vector<KernelEntry> all;
+        for (KernelFamily family : {KernelFamily::UVOffset, KernelFamily::Karatsuba, KernelFamily::SoftFloat})
+        {
+            for (const IsaKernels& isa : isas)
+            {
+                if (!dispatch::isaSupported(isa.isa))
+                {
+                    continue;
+                }
+                for (const KernelEntry& entry : isa.kernels())
+                {
+                    if (entry.info.family == family)
+                    {
+                        names.push_back(std::string(entry.info.name) + " (" + dispatch::isaName(isa.isa) + ")");
+                        all.push_back({{names.back().c_str(), family}, entry.function});
+                    }
+                }
+            }
+            for (const KernelEntry& entry : others)
+            {
+                if (entry.info.family == family)
+                {
+                    all.push_back(entry);
+                }
+            }
+        }
+        return all;
+    }();
+    return entries;
+}
+
+Inputs generateInputs(KernelFamily family, size_t count)
+{
+    Inputs inputs;
+    std::mt19937 rng(1234);
+    switch (family)
+    {
+    case KernelFamily::UVOffset:
+    {
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        inputs.uvs.resize(2*count);
+        for (float& value : inputs.uvs)
+        {
+            value = unit(rng);
+        }
+        break;
+    }
+    case KernelFamily::Karatsuba:
+        inputs.integers.resize(2*count);
+        for (uint32_t& value : inputs.integers)
+        {
+            value = rng() & 0xFFFF;
+        }
+        break;
+    case KernelFamily::SoftFloat:
+        inputs.floats.resize(2*count);
+        for (float& value : inputs.floats)
+        {
+            // normal floats whose results stay normal
+            uint32_t bits = (rng() & 0x807FFFFFu) | ((65 + rng() % 125) << 23);
+            std::memcpy(&value, &bits, sizeof(bits));
+        }
+        break;
+    }
+    return inputs;
+}
+
+}
+
+const std::vector<KernelInfo>& availableKernels()
+{
+    static const std::vector<KernelInfo> kernels = [] {
+        std::vector<KernelInfo> infos;
+        for (const KernelEntry& entry : kernelEntries())
+        {
+            infos.push_back(entry.info);
+        }
+        return infos;
+    }();
+    return kernels;
+}
+
+const char* familyName(KernelFamily family)
+{
+    switch (family)
+    {
+    case KernelFamily::UVOffset:
+        return "uv offset";
+    case KernelFamily::Karatsuba:
+        return "karatsuba";
+    default:
+        return "soft float";
+    }
+}
+
+double percentile(std::vector<double>& values, double percent)
+{
+    if (values.empty())
+    {
+        return 0.0;
+    }
+    size_t index = static_cast<size_t>(percent / 100.0 * double(values.size() - 1) + 0.5);
+    index = std::min(index, values.size() - 1);
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+void runBenchmark(const BenchmarkConfig& config,
+                  const std::function<void(const BenchmarkSample&)>& onSample,
+                  const std::atomic<bool>* cancel)
+{
+    const KernelEntry& entry = kernelEntries().at(config.kernelIndex);
+    const size_t inputSize = std::max<size_t>(config.inputSize, 1);
+    const unsigned threads = std::max(config.threads, 1u);
+    const Inputs inputs = generateInputs(entry.info.family, inputSize);
+
+    // every thread fills its own latencies, the first barrier completion
+    // merges them once all the threads are done with the sample, then the
+    // calling thread hands the sample out while the others wait on the
+    // second barrier, so onSample always runs on the calling thread
+    std::vector<std::vector<double>> latencies(threads);
+    std::vector<uint32_t> checksums(threads, 0);
+    std::vector<double> merged;
+    BenchmarkSample sample;
+    bool stop = false;
+    auto sampleStart = std::chrono::steady_clock::now();
+
+    auto mergeSample = [&]() noexcept {
+        auto now = std::chrono::steady_clock::now();
+        double seconds = std::chrono::duration<double>(now - sampleStart).count();
+        merged.clear();
+        for (std::vector<double>& perThread : latencies)
+        {
+            merged.insert(merged.end(), perThread.begin(), perThread.end());
+            perThread.clear();
+        }
+        sample.throughput = double(inputSize) * threads / seconds;
+        sample.latencyP50 = percentile(merged, 50.0);
+        sample.latencyP90 = percentile(merged, 90.0);
+        sample.latencyP99 = percentile(merged, 99.0);
+    };
+    auto nextSample = [&]() noexcept {
+        ++sample.index;
+        stop = sample.index >= config.samples || (cancel && cancel->load());
+        sampleStart = std::chrono::steady_clock::now();
+    };
+    std::barrier<decltype(mergeSample)> sampleDone(threads, mergeSample);
+    std::barrier<decltype(nextSample)> sampleDelivered(threads, nextSample);
+
+    auto work = [&](unsigned thread) {
+        instrumentation::registerThisThread();
+        // the uv and batch kernels need somewhere to write
+        std::vector<float> scratch(2*inputSize);
+        std::vector<double>& own = latencies[thread];
+        while (!stop)
+        {
+            for (size_t begin = 0; begin < inputSize; begin += CHUNK)
+            {
+                size_t end = std::min(begin + CHUNK, inputSize);
+                auto start = std::chrono::steady_clock::now();
+                checksums[thread] += entry.function(inputs, scratch, begin, end);
+                auto finish = std::chrono::steady_clock::now();
+                own.push_back(std::chrono::duration<double, std::nano>(finish - start).count() /
+                              double(end - begin));
+            }
+            sampleDone.arrive_and_wait();
+            if (thread == 0)
+            {
+                onSample(sample);
+            }
+            sampleDelivered.arrive_and_wait();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t)
+    {
+        pool.emplace_back(work, t);
+    }
+    work(0);
+    for (std::thread& thread : pool)
+    {
+        thread.join();
+    }
+}
+
+}
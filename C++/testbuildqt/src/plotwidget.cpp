@@ -0,0 +1,111 @@
+#include <plotwidget.h>
+
+#include <QtGui/QPainter>
+#include <QtGui/QPainterPath>
+
+#include <algorithm>
+
+PlotWidget::PlotWidget(const QString& title, QWidget *parent)
+    : QWidget(parent), title(title), history(200)
+{
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+}
+
+int PlotWidget::addSeries(const QString& name, const QColor& color)
+{
+    series.push_back({name, color, {}});
+    return series.size() - 1;
+}
+
+void PlotWidget::append(int index, double value)
+{
+    QVector<double>& values = series[index].values;
+    values.push_back(value);
+    if (values.size() > history)
+    {
+        values.remove(0, values.size() - history);
+    }
+    update();
+}
+
+void PlotWidget::clear()
+{
+    for (Series& s : series)
+    {
+        s.values.clear();
+    }
+    update();
+}
+
+void PlotWidget::setHistory(int points)
+{
+    history = std::max(points, 2);
+}
+
+QSize PlotWidget::minimumSizeHint() const
+{
+    return QSize(300, 150);
+}
+
+void PlotWidget::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.fillRect(rect(), palette().base());
+
+    const int margin = 8;
+    const int textHeight = fontMetrics().height();
+    QRect area = rect().adjusted(margin, textHeight + margin, -margin, -margin);
+
+    double top = 0.0;
+    for (const Series& s : series)
+    {
+        for (double value : s.values)
+        {
+            top = std::max(top, value);
+        }
+    }
+    if (top <= 0.0)
+    {
+        top = 1.0;
+    }
+
+    painter.setPen(palette().color(QPalette::Mid));
+    painter.drawRect(area);
+    painter.setPen(palette().color(QPalette::Text));
+    painter.drawText(margin, textHeight, QString("%1 (max %2)").arg(title).arg(top, 0, 'g', 4));
+
+    // legend on the right of the title
+    int legendX = width() - margin;
+    for (int i = series.size() - 1; i >= 0; --i)
+    {
+        legendX -= fontMetrics().horizontalAdvance(series[i].name) + margin;
+        painter.setPen(series[i].color);
+        painter.drawText(legendX, textHeight, series[i].name);
+    }
+
+    const double stepX = double(area.width()) / double(history - 1);
+    for (const Series& s : series)
+    {
+        if (s.values.size() < 2)
+        {
+            continue;
+        }
+        QPainterPath path;
+        for (int i = 0; i < s.values.size(); ++i)
+        {
+            QPointF point(area.left() + i * stepX,
+                          area.bottom() - s.values[i] / top * area.height());
+            if (i == 0)
+            {
+                path.moveTo(point);
+            }
+            else
+            {
+                path.lineTo(point);
+            }
+        }
+        painter.setPen(QPen(s.color, 1.5));
+        painter.drawPath(path);
+    }
+}
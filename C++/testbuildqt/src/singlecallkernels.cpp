@@ -0,0 +1,60 @@
+// compiled once per instruction set, see isaDispatch.h
+
+#include <kernelentries.h>
+
+#include "../../branchless/uv.h"
+#include "../../dispatch/isaDispatch.h"
+#include "../../floatingPoint/floatingPointSoftware.h"
+
+#include <cstring>
+
+namespace kernel_console {
+
+namespace {
+
+template <void (*KERNEL)(const float[2], float[2])>
+uint32_t uvSingle(const Inputs& in, std::vector<float>& out, size_t begin, size_t end)
+{
+    for (size_t i = begin; i < end; ++i)
+    {
+        KERNEL(&in.uvs[2*i], &out[2*i]);
+    }
+    uint32_t bits;
+    std::memcpy(&bits, &out[2*begin], sizeof(bits));
+    return bits;
+}
+
+template <SWFloat (*OPERATION)(SWFloat, SWFloat)>
+uint32_t softFloatSingle(const Inputs& in, std::vector<float>&, size_t begin, size_t end)
+{
+    uint32_t checksum = 0;
+    for (size_t i = begin; i < end; ++i)
+    {
+        SWFloat a;
+        SWFloat b;
+        a.original = in.floats[2*i];
+        b.original = in.floats[2*i+1];
+        checksum += OPERATION(a, b).mantissa;
+    }
+    return checksum;
+}
+
+}
+
+const std::vector<KernelEntry>& KERNEL_ISA_NAME(singleCallKernels)()
+{
+    static const std::vector<KernelEntry> entries = {
+        {{"offsetUVs", KernelFamily::UVOffset}, uvSingle<offsetUVs>},
+        {{"offsetUVsNoBranch3", KernelFamily::UVOffset}, uvSingle<offsetUVsNoBranch3>},
+#if defined(__AVX2__) && defined(__BMI2__)
+        {{"offsetUVsNoBranch1", KernelFamily::UVOffset}, uvSingle<offsetUVsNoBranch1>},
+        {{"offsetUVsNoBranch2", KernelFamily::UVOffset}, uvSingle<offsetUVsNoBranch2>},
+#endif
+        {{"swFloatAddition", KernelFamily::SoftFloat}, softFloatSingle<swFloatAddition>},
+        {{"swFloatMultiplication", KernelFamily::SoftFloat}, softFloatSingle<swFloatMultiplication>},
+        {{"swFloatDivision", KernelFamily::SoftFloat}, softFloatSingle<swFloatDivision>},
+    };
+    return entries;
+}
+
+}
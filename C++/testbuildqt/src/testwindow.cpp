@@ -1,7 +1,258 @@
 #include <testwindow.h>
+#include <jobs.h>
+#include <plotwidget.h>
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QThread>
+#include <QtGui/QShowEvent>
+#include <QtWidgets/QComboBox>
+#include <QtWidgets/QFormLayout>
+#include <QtWidgets/QHBoxLayout>
+#include <QtWidgets/QLabel>
+#include <QtWidgets/QProgressBar>
+#include <QtWidgets/QPushButton>
+#include <QtWidgets/QSpinBox>
+#include <QtWidgets/QVBoxLayout>
+
+#include <algorithm>
+
+namespace {
+
+// 30 updates a second are plenty for the eye, the events queue up in between
+const int POLL_INTERVAL_MS = 33;
+
+enum JobType { BenchmarkJob, UVMeshJob, AdditionSweepJob, MultiplicationSweepJob, DivisionSweepJob };
+
+}
 
 TestWindow::TestWindow(QMainWindow *parent)
-    : QMainWindow(parent) 
+    : QMainWindow(parent), jobBox(0), plotLayout(0), throughputPlot(0), latencyPlot(0), currentJob(0),
+      quitWhenDone(false), failed(false)
 {
     ui.setupUi(this);
-}
\ No newline at end of file
+    connect(&pollTimer, &QTimer::timeout, this, &TestWindow::pollJobs);
+}
+
+TestWindow::~TestWindow()
+{
+    // the scheduler destructor cancels and joins, nothing is polled anymore
+    pollTimer.stop();
+}
+
+void TestWindow::showEvent(QShowEvent *event)
+{
+    // comes right before the window gets on screen, a window that is never
+    // shown never builds anything
+    if (!jobBox)
+    {
+        buildDashboard();
+    }
+    QMainWindow::showEvent(event);
+}
+
+kernel_console::JobScheduler& TestWindow::jobScheduler()
+{
+    // the pool threads get started with the first job
+    if (!scheduler)
+    {
+        scheduler.reset(new kernel_console::JobScheduler);
+        pollTimer.start(POLL_INTERVAL_MS);
+    }
+    return *scheduler;
+}
+
+void TestWindow::buildDashboard()
+{
+    jobBox = new QComboBox;
+    jobBox->addItem("Benchmark");
+    jobBox->addItem("UV mesh");
+    jobBox->addItem("Soft float addition sweep");
+    jobBox->addItem("Soft float multiplication sweep");
+    jobBox->addItem("Soft float division sweep");
+
+    kernelBox = new QComboBox;
+    for (const kernel_console::KernelInfo& kernel : kernel_console::availableKernels())
+    {
+        kernelBox->addItem(QString("%1: %2").arg(kernel_console::familyName(kernel.family), kernel.name));
+    }
+
+    sizeBox = new QSpinBox;
+    sizeBox->setRange(1, 1 << 28);
+    sizeBox->setValue(1 << 16);
+    sizeBox->setSingleStep(1024);
+
+    threadBox = new QSpinBox;
+    threadBox->setRange(1, std::max(QThread::idealThreadCount(), 1) * 2);
+    threadBox->setValue(1);
+
+    sampleBox = new QSpinBox;
+    sampleBox->setRange(1, 100000);
+    sampleBox->setValue(200);
+
+    runButton = new QPushButton("Run");
+    connect(runButton, &QPushButton::clicked, this, &TestWindow::submitJob);
+    stopButton = new QPushButton("Stop all");
+    connect(stopButton, &QPushButton::clicked, this, &TestWindow::cancelJobs);
+
+    progressBar = new QProgressBar;
+    progressBar->setRange(0, 1000);
+    progressBar->setValue(0);
+
+    QFormLayout *controls = new QFormLayout;
+    controls->addRow("Job", jobBox);
+    controls->addRow("Kernel", kernelBox);
+    controls->addRow("Input size", sizeBox);
+    controls->addRow("Threads", threadBox);
+    controls->addRow("Samples", sampleBox);
+    controls->addRow(runButton);
+    controls->addRow(stopButton);
+    controls->addRow(progressBar);
+
+    // the plots come with the first benchmark
+    plotLayout = new QVBoxLayout;
+    QHBoxLayout *layout = new QHBoxLayout(ui.centralWidget);
+    layout->addLayout(controls);
+    layout->addLayout(plotLayout, 1);
+
+    statusLabel = new QLabel("Idle");
+    ui.statusBar->addWidget(statusLabel, 1);
+    resize(900, 500);
+}
+
+void TestWindow::buildPlots()
+{
+    throughputPlot = new PlotWidget("Throughput (calls/s)");
+    throughputSeries = throughputPlot->addSeries("calls/s", QColor(40, 110, 200));
+    latencyPlot = new PlotWidget("Latency (ns/call)");
+    p50Series = latencyPlot->addSeries("p50", QColor(40, 160, 60));
+    p90Series = latencyPlot->addSeries("p90", QColor(220, 150, 20));
+    p99Series = latencyPlot->addSeries("p99", QColor(200, 40, 40));
+    plotLayout->addWidget(throughputPlot);
+    plotLayout->addWidget(latencyPlot);
+}
+
+void TestWindow::submitJob()
+{
+    const size_t size = sizeBox->value();
+    kernel_console::Job job;
+    switch (jobBox->currentIndex())
+    {
+    case BenchmarkJob:
+    {
+        kernel_console::BenchmarkConfig config;
+        config.kernelIndex = kernelBox->currentIndex();
+        config.inputSize = size;
+        config.threads = threadBox->value();
+        config.samples = sampleBox->value();
+        if (!throughputPlot)
+        {
+            buildPlots();
+        }
+        throughputPlot->clear();
+        latencyPlot->clear();
+        throughputPlot->setHistory(config.samples);
+        latencyPlot->setHistory(config.samples);
+        job = kernel_console::benchmarkJob(config);
+        break;
+    }
+    case UVMeshJob:
+        job = kernel_console::uvMeshJob(size);
+        break;
+    case AdditionSweepJob:
+        job = kernel_console::softFloatSweepJob(kernel_console::SoftFloatOperation::Addition, size);
+        break;
+    case MultiplicationSweepJob:
+        job = kernel_console::softFloatSweepJob(kernel_console::SoftFloatOperation::Multiplication, size);
+        break;
+    default:
+        job = kernel_console::softFloatSweepJob(kernel_console::SoftFloatOperation::Division, size);
+        break;
+    }
+    currentJob = jobScheduler().submit(job);
+    progressBar->setValue(0);
+    updateStatus();
+}
+
+void TestWindow::runSmokeJob()
+{
+    if (!jobBox)
+    {
+        buildDashboard();
+    }
+    jobBox->setCurrentIndex(BenchmarkJob);
+    kernelBox->setCurrentIndex(0);
+    sizeBox->setValue(1024);
+    threadBox->setValue(1);
+    sampleBox->setValue(3);
+    quitWhenDone = true;
+    submitJob();
+}
+
+void TestWindow::cancelJobs()
+{
+    if (scheduler)
+    {
+        scheduler->cancelAll();
+    }
+}
+
+void TestWindow::pollJobs()
+{
+    if (scheduler->poll([this](const kernel_console::JobEvent& event) { handleEvent(event); }))
+    {
+        updateStatus();
+    }
+}
+
+void TestWindow::handleEvent(const kernel_console::JobEvent& event)
+{
+    switch (event.kind)
+    {
+    case kernel_console::JobEvent::Progress:
+        if (event.job == currentJob)
+        {
+            progressBar->setValue(int(event.progress * 1000));
+        }
+        break;
+    case kernel_console::JobEvent::Sample:
+        if (event.job == currentJob && throughputPlot)
+        {
+            throughputPlot->append(throughputSeries, event.sample.throughput);
+            latencyPlot->append(p50Series, event.sample.latencyP50);
+            latencyPlot->append(p90Series, event.sample.latencyP90);
+            latencyPlot->append(p99Series, event.sample.latencyP99);
+        }
+        break;
+    case kernel_console::JobEvent::Result:
+        lastResult = QString("job %1: %2 items in %3 s, %4 Mitems/s, %5 failures")
+                         .arg(event.job)
+                         .arg(qulonglong(event.items))
+                         .arg(event.seconds, 0, 'f', 3)
+                         .arg(event.seconds > 0.0 ? event.items / event.seconds / 1e6 : 0.0, 0, 'f', 2)
+                         .arg(qulonglong(event.failures));
+        failed |= event.failures != 0 || event.items == 0;
+        break;
+    case kernel_console::JobEvent::Finished:
+    case kernel_console::JobEvent::Cancelled:
+        if (event.job == currentJob)
+        {
+            progressBar->setValue(1000);
+            if (quitWhenDone)
+            {
+                QCoreApplication::exit(failed || event.kind == kernel_console::JobEvent::Cancelled ? 1 : 0);
+            }
+        }
+        break;
+    }
+}
+
+void TestWindow::updateStatus()
+{
+    QString status = scheduler->pending() ? QString("%1 jobs running").arg(qulonglong(scheduler->pending()))
+                                         : QString("Idle");
+    if (!lastResult.isEmpty())
+    {
+        status += ", last " + lastResult;
+    }
+    statusLabel->setText(status);
+}